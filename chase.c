@@ -11,12 +11,13 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <curses.h>
 #include "rogue.h"
 
 #define DRAGONSHOT  5	/* one chance in DRAGONSHOT that a dragon will flame */
 
-static coord ch_ret;				/* Where chasing takes you */
+static TLOCAL coord ch_ret;				/* Where chasing takes you */
 
 /*
  * runners:
@@ -28,7 +29,7 @@ runners()
     register THING *tp;
     THING *next;
     bool wastarget;
-    static coord orig_pos;
+    static TLOCAL coord orig_pos;
 
     for (tp = mlist; tp != NULL; tp = next)
     {
@@ -89,12 +90,14 @@ relocate(THING *th, coord *new_loc)
 	th->t_room = roomin(new_loc);
 	set_oldch(th, new_loc);
 	oroom = th->t_room;
-	moat(th->t_pos.y, th->t_pos.x) = NULL;
+	set_moat(th->t_pos.y, th->t_pos.x, NULL);
 
 	if (oroom != th->t_room)
 	    th->t_dest = find_dest(th);
+	hash_detach(&mlist, th);
 	th->t_pos = *new_loc;
-	moat(new_loc->y, new_loc->x) = th;
+	hash_attach(&mlist, th);
+	set_moat(new_loc->y, new_loc->x, th);
     }
     move(new_loc->y, new_loc->x);
     if (see_monst(th))
@@ -118,9 +121,9 @@ do_chase(THING *th)
     register struct room *rer, *ree;	/* room of chaser, room of chasee */
     register int mindist = 32767, curdist;
     register bool stoprun = FALSE;	/* TRUE means we are there */
-    register bool door;
+    register bool door, flowing;
     register THING *obj;
-    static coord this;			/* Temporary destination for chaser */
+    static TLOCAL coord this;			/* Temporary destination for chaser */
 
     rer = th->t_room;		/* Find room of chaser */
     if (on(*th, ISGREED) && rer->r_goldval == 0)
@@ -133,13 +136,18 @@ do_chase(THING *th)
      * We don't count doors as inside rooms for this routine
      */
     door = (chat(th->t_pos.y, th->t_pos.x) == DOOR);
+    /*
+     * If we can follow the distance field to the hero, it already
+     * knows the way out of the room.
+     */
+    flowing = flow_chase(th);
     /*
      * If the object of our desire is in a different room,
      * and we are not in a corridor, run to the door nearest to
      * our goal.
      */
 over:
-    if (rer != ree)
+    if (rer != ree && !flowing)
     {
 	for (cp = rer->r_exit; cp < &rer->r_exit[rer->r_nexits]; cp++)
 	{
@@ -165,7 +173,7 @@ over:
 	 * line from it, and (b) that it is within shooting distance,
 	 * but outside of striking range.
 	 */
-	if (th->t_type == 'D' && (th->t_pos.y == hero.y || th->t_pos.x == hero.x
+	if (rer == ree && th->t_type == 'D' && (th->t_pos.y == hero.y || th->t_pos.x == hero.x
 	    || abs(th->t_pos.y - hero.y) == abs(th->t_pos.x - hero.x))
 	    && dist_cp(&th->t_pos, &hero) <= BOLT_LENGTH * BOLT_LENGTH
 	    && !on(*th, ISCANC) && rnd(DRAGONSHOT) == 0)
@@ -204,8 +212,8 @@ over:
 		{
 		    detach(lvl_obj, obj);
 		    attach(th->t_pack, obj);
-		    chat(obj->o_pos.y, obj->o_pos.x) =
-			(th->t_room->r_flags & ISGONE) ? PASSAGE : FLOOR;
+		    set_chat(obj->o_pos.y, obj->o_pos.x,
+			(th->t_room->r_flags & ISGONE) ? PASSAGE : FLOOR);
 		    th->t_dest = find_dest(th);
 		    break;
 		}
@@ -319,7 +327,10 @@ chase(THING *tp, coord *ee)
     register coord *er = &tp->t_pos;
     register char ch;
     register int plcnt = 1;
-    static coord tryp;
+    register bool flowing;
+    static TLOCAL coord tryp;
+
+    flowing = (ce(*ee, hero) && flow_chase(tp));
 
     /*
      * If the thing is confused, let it move randomly. Invisible
@@ -333,7 +344,10 @@ chase(THING *tp, coord *ee)
 	 * get a valid random move
 	 */
 	ch_ret = *rndmove(tp);
-	curdist = dist_cp(&ch_ret, ee);
+	if (flowing)
+	    curdist = places.p_dist[INDEX(ch_ret.y, ch_ret.x)];
+	else
+	    curdist = dist_cp(&ch_ret, ee);
 	/*
 	 * Small chance that it will become un-confused 
 	 */
@@ -351,7 +365,10 @@ chase(THING *tp, coord *ee)
 	 * This will eventually hold where we move to get closer
 	 * If we can't find an empty spot, we stay where we are.
 	 */
-	curdist = dist_cp(er, ee);
+	if (flowing)
+	    curdist = places.p_dist[INDEX(er->y, er->x)];
+	else
+	    curdist = dist_cp(er, ee);
 	ch_ret = *er;
 
 	ey = er->y + 1;
@@ -397,7 +414,10 @@ chase(THING *tp, coord *ee)
 		     * If we didn't find any scrolls at this place or it
 		     * wasn't a scare scroll, then this place counts
 		     */
-		    thisdist = dist(y, x, ee->y, ee->x);
+		    if (flowing)
+			thisdist = places.p_dist[INDEX(y, x)];
+		    else
+			thisdist = dist(y, x, ee->y, ee->x);
 		    if (thisdist < curdist)
 		    {
 			plcnt = 1;
@@ -416,6 +436,216 @@ chase(THING *tp, coord *ee)
     return (bool)(curdist != 0 && !ce(ch_ret, hero));
 }
 
+/*
+ * The distance field is walked out breadth first from the hero, but
+ * only as far as the monsters chasing him need it; the queue is kept
+ * so that it can be walked out further when someone farther away
+ * starts asking.  Which ways a monster can step from each spot is
+ * worked out once a level, so the inner loop does not have to keep
+ * asking step_ok() and diag_ok() about the same spots.  All of it
+ * belongs to the game, like the field itself.
+ */
+#define walk		(game->g_flow.f_walk)
+#define moves		(game->g_flow.f_moves)
+#define queue		(game->g_flow.f_queue)
+#define queued		(game->g_flow.f_queued)
+#define q_head		(game->g_flow.f_head)
+#define q_tail		(game->g_flow.f_tail)
+
+static int flow_dy[8] = { -1, -1, -1,  0, 0,  1, 1, 1 };
+static int flow_dx[8] = { -1,  0,  1, -1, 1, -1, 0, 1 };
+static int flow_off[8] = {
+    -MAXCOLS - 1, -MAXCOLS, -MAXCOLS + 1, -1, 1, MAXCOLS - 1, MAXCOLS, MAXCOLS + 1
+};
+
+/*
+ * walkable:
+ *	Returns TRUE if a monster could step on the spot
+ */
+static bool
+walkable(int y, int x)
+{
+    return (bool)(x >= 0 && x < NUMCOLS && y > 0 && y < NUMLINES - 1
+		  && step_ok(chat(y, x)));
+}
+
+/*
+ * flow_moves:
+ *	Work out which ways a monster standing at (y, x) could step
+ */
+static void
+flow_moves(int y, int x)
+{
+    register int i, k, nx, dy, dx;
+    register unsigned char m;
+
+    if (x < 0 || x >= NUMCOLS || y <= 0 || y >= NUMLINES - 1)
+	return;
+    i = INDEX(y, x);
+    m = 0;
+    if (walk[i])
+	for (k = 0; k < 8; k++)
+	{
+	    dy = flow_dy[k];
+	    dx = flow_dx[k];
+	    nx = x + dx;
+	    if (nx < 0 || nx >= NUMCOLS || !walk[i + flow_off[k]])
+		continue;
+	    if (dy != 0 && dx != 0 && !(walk[i + dy * MAXCOLS] && walk[i + dx]))
+		continue;
+	    m |= 1 << k;
+	}
+    moves[i] = m;
+}
+
+/*
+ * flow_push:
+ *	Put a spot whose distance just went down on the queue
+ */
+static void
+flow_push(int i)
+{
+    if (!queued[i])
+    {
+	queued[i] = TRUE;
+	queue[q_tail] = i;
+	q_tail = (q_tail + 1) % (MAXLINES * MAXCOLS);
+    }
+}
+
+/*
+ * flow_spread:
+ *	Carry the distances in the field out from the spots waiting in
+ *	the queue, until every spot up to the given distance away (and
+ *	so every spot next to one of them) has its final distance.
+ */
+static void
+flow_spread(unsigned short upto)
+{
+    register int i, j, k;
+    register unsigned char m;
+    register unsigned short d;
+
+    while (q_head != q_tail && places.p_dist[queue[q_head]] <= upto)
+    {
+	i = queue[q_head];
+	q_head = (q_head + 1) % (MAXLINES * MAXCOLS);
+	queued[i] = FALSE;
+	d = places.p_dist[i] + 1;
+	for (m = moves[i], k = 0; m != 0; m >>= 1, k++)
+	{
+	    if (!(m & 1))
+		continue;
+	    j = i + flow_off[k];
+	    if (places.p_dist[j] <= d)
+		continue;
+	    places.p_dist[j] = d;
+	    flow_push(j);
+	}
+    }
+}
+
+/*
+ * flow_field:
+ *	Make sure the distance field leads to where the hero is now.  It
+ *	is only started over after he has moved, and the moves out of
+ *	each spot are only worked out again when the level changed.
+ */
+void
+flow_field()
+{
+    register int y, x;
+
+    if (game->g_flow_ok && ce(game->g_flow_at, hero))
+	return;
+    if (!game->g_flow_ok)
+    {
+	for (y = 0; y < MAXLINES; y++)
+	    for (x = 0; x < MAXCOLS; x++)
+		walk[INDEX(y, x)] = walkable(y, x);
+	memset(moves, 0, sizeof moves);
+	for (y = 1; y < NUMLINES - 1; y++)
+	    for (x = 0; x < NUMCOLS; x++)
+		flow_moves(y, x);
+    }
+    memset(places.p_dist, 0xff, sizeof places.p_dist);
+    memset(queued, FALSE, sizeof queued);
+    q_head = q_tail = 0;
+    places.p_dist[INDEX(hero.y, hero.x)] = 0;
+    flow_push(INDEX(hero.y, hero.x));
+    game->g_flow_at = hero;
+    game->g_flow_ok = TRUE;
+}
+
+/*
+ * flow_open:
+ *	Something at (y, x) can now be walked on, so patch up the field
+ *	around it instead of starting it over.  Opening a spot also lets
+ *	monsters cut the corners next to it, so every spot around it is
+ *	looked at again as well.
+ */
+void
+flow_open(int y, int x)
+{
+    register int i, j, k, sy, sx, best;
+
+    if (!game->g_flow_ok)
+	return;
+    walk[INDEX(y, x)] = walkable(y, x);
+    for (sy = y - 1; sy <= y + 1; sy++)
+	for (sx = x - 1; sx <= x + 1; sx++)
+	    flow_moves(sy, sx);
+    if (!ce(game->g_flow_at, hero))
+	return;
+    /*
+     * The queue only stays in order of distance while it is walked
+     * out from the hero, so finish that before patching.
+     */
+    flow_spread(FARAWAY);
+    for (sy = y - 1; sy <= y + 1; sy++)
+	for (sx = x - 1; sx <= x + 1; sx++)
+	{
+	    if (!walkable(sy, sx))
+		continue;
+	    i = INDEX(sy, sx);
+	    best = places.p_dist[i];
+	    for (k = 0; k < 8; k++)
+	    {
+		if (!(moves[i] & (1 << k)))
+		    continue;
+		j = places.p_dist[i + flow_off[k]];
+		if (j != FARAWAY && j + 1 < best)
+		    best = j + 1;
+	    }
+	    if (best < places.p_dist[i])
+	    {
+		places.p_dist[i] = (unsigned short) best;
+		flow_push(i);
+	    }
+	}
+    flow_spread(FARAWAY);
+}
+
+/*
+ * flow_chase:
+ *	Returns TRUE if the monster is after the hero and can follow the
+ *	distance field to get to him.
+ */
+bool
+flow_chase(THING *tp)
+{
+    register int i;
+
+    if (!flowchase || tp->t_dest != &hero)
+	return FALSE;
+    flow_field();
+    i = INDEX(tp->t_pos.y, tp->t_pos.x);
+    while (places.p_dist[i] == FARAWAY && q_head != q_tail)
+	flow_spread(places.p_dist[queue[q_head]]);
+    flow_spread(places.p_dist[i]);
+    return (bool)(places.p_dist[i] != FARAWAY);
+}
+
 /*
  * roomin:
  *	Find what room some coordinates are in. NULL means they aren't
@@ -424,18 +654,13 @@ chase(THING *tp, coord *ee)
 struct room *
 roomin(coord *cp)
 {
-    register struct room *rp;
-    register char *fp;
-
-
-    fp = &flat(cp->y, cp->x);
-    if (*fp & F_PASS)
-	return &passages[*fp & F_PNUM];
+    register int i;
 
-    for (rp = rooms; rp < &rooms[MAXROOMS]; rp++)
-	if (cp->x <= rp->r_pos.x + rp->r_max.x && rp->r_pos.x <= cp->x
-	 && cp->y <= rp->r_pos.y + rp->r_max.y && rp->r_pos.y <= cp->y)
-	    return rp;
+    i = INDEX(cp->y, cp->x);
+    if (places.p_flags[i] & F_PASS)
+	return &passages[places.p_flags[i] & F_PNUM];
+    if (places.p_room[i] != 0)
+	return &rooms[places.p_room[i] - 1];
 
     msg("in some bizarre place (%d, %d)", unc(*cp));
 #ifdef MASTER
@@ -468,7 +693,7 @@ bool
 cansee(int y, int x)
 {
     register struct room *rer;
-    static coord tp;
+    static TLOCAL coord tp;
 
     if (on(player, ISBLIND))
 	return FALSE;
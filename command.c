@@ -11,11 +11,16 @@
  */
 
 #include <stdlib.h>
+#include <limits.h>
 #include <string.h>
 #include <curses.h>
 #include <ctype.h>
 #include "rogue.h"
 
+#define countch		(game->g_countch)
+#define direction	(game->g_direction)
+#define newcount	(game->g_newcount)
+
 /*
  * command:
  *	Process the user commands
@@ -27,13 +32,20 @@ command()
     register int ntimes = 1;			/* Number of player moves */
     char *fp;
     THING *mp;
-    static char countch, direction, newcount = FALSE;
 
+    /*
+     * If he is just waiting, let the turns go by without showing him
+     * each one
+     */
+    if (fast_forward() != 0)
+	return;
     if (on(player, ISHASTE))
 	ntimes++;
     /*
      * Let the daemons start up
      */
+    turns++;
+    anim_turn();
     do_daemons(BEFORE);
     do_fuses(BEFORE);
     while (ntimes--)
@@ -57,8 +69,8 @@ command()
 	status();
 	lastscore = purse;
 	move(hero.y, hero.x);
-	if (!((running || count) && jump))
-	    refresh();			/* Draw screen */
+	if (!((running || count) && (jump || skip_frame())))
+	    end_frame();		/* Draw screen */
 	take = 0;
 	after = TRUE;
 	/*
@@ -104,9 +116,8 @@ command()
 		newcount = TRUE;
 		while (isdigit(ch))
 		{
-		    count = count * 10 + (ch - '0');
-		    if (count > 255)
-			count = 255;
+		    if (count <= (INT_MAX - 9) / 10)
+			count = count * 10 + (ch - '0');
 		    ch = readchar();
 		}
 		countch = ch;
@@ -370,7 +381,9 @@ over:
 		    {
 			case '|': msg("@ %d,%d", hero.y, hero.x);
 			when 'C': create_obj();
-			when '$': msg("inpack = %d", inpack);
+			when '$': msg("inpack = %d, things = %d (most %d) in %d slabs",
+				inpack, game->g_in_use, game->g_most_in_use,
+				game->g_slabs);
 			when CTRL('G'): inventory(lvl_obj, 0);
 			when CTRL('W'): whatis(FALSE, 0);
 			when CTRL('D'): level++; new_level();
@@ -451,6 +464,105 @@ over:
 	search();
     else if (ISRING(RIGHT, R_TELEPORT) && rnd(50) == 0)
 	teleport();
+    hash_turn();
+    checkpoint();
+}
+
+/*
+ * can_skip:
+ *	Returns TRUE if the next turn can go by without being shown:
+ *	he is resting, searching or held, no monster is up and about
+ *	or next to him, and there is nothing new he would need to see.
+ */
+static bool
+can_skip()
+{
+    register THING *tp;
+    register int y, x;
+
+    if (no_command == 0 && (count == 0 || (countch != '.' && countch != 's')))
+	return FALSE;
+    if (running || to_death || has_hit || stat_msg || mpos != 0)
+	return FALSE;
+    if (on(player, ISHASTE|ISHALU) || !ce(oldpos, hero))
+	return FALSE;
+    for (tp = mlist; tp != NULL; tp = next(tp))
+	if (on(*tp, ISRUN))
+	    return FALSE;
+    for (y = hero.y - 1; y <= hero.y + 1; y++)
+	for (x = hero.x - 1; x <= hero.x + 1; x++)
+	    if (y > 0 && y < NUMLINES - 1 && x >= 0 && x < NUMCOLS
+	      && moat(y, x) != NULL)
+		return FALSE;
+    return TRUE;
+}
+
+/*
+ * fast_forward:
+ *	Let turns go by one after another while he waits, doing just
+ *	what command() would do for a rest, a search or a turn he can't
+ *	move, but without drawing anything.  It stops as soon as there
+ *	is something to show him, and command() takes over from there.
+ *	Returns how many turns went by.
+ */
+int
+fast_forward()
+{
+    int n;
+
+    for (n = 0; can_skip(); n++)
+    {
+	turns++;
+	do_daemons(BEFORE);
+	do_fuses(BEFORE);
+	again = FALSE;
+	if (on(player, ISSLOW|ISGREED|ISINVIS|ISREGEN|ISTARGET))
+	    exit(1);
+	door_stop = FALSE;
+	lastscore = purse;
+	take = 0;
+	after = TRUE;
+#ifdef MASTER
+	if (wizard)
+	    noscore = TRUE;
+#endif
+	if (no_command)
+	{
+	    if (--no_command == 0)
+	    {
+		player.t_flags |= ISRUN;
+		msg("you can move again");
+	    }
+	}
+	else
+	{
+	    newcount = FALSE;
+	    if (--count == 0)
+	    {
+		l_last_comm = last_comm;
+		l_last_dir = last_dir;
+		l_last_pick = last_pick;
+		last_comm = countch;
+		last_dir = '\0';
+		last_pick = NULL;
+	    }
+	    if (countch == 's')
+		search();
+	}
+	do_daemons(AFTER);
+	do_fuses(AFTER);
+	if (ISRING(LEFT, R_SEARCH))
+	    search();
+	else if (ISRING(LEFT, R_TELEPORT) && rnd(50) == 0)
+	    teleport();
+	if (ISRING(RIGHT, R_SEARCH))
+	    search();
+	else if (ISRING(RIGHT, R_TELEPORT) && rnd(50) == 0)
+	    teleport();
+	hash_turn();
+	checkpoint();
+    }
+    return n;
 }
 
 /*
@@ -497,18 +609,19 @@ search()
 		    case '-':
 			if (rnd(5 + probinc) != 0)
 			    break;
-			chat(y, x) = DOOR;
+			set_chat(y, x, DOOR);
                         msg("a secret door");
 foundone:
 			found = TRUE;
 			*fp |= F_REAL;
+			flow_open(y, x);
 			count = FALSE;
 			running = FALSE;
 			break;
 		    case FLOOR:
 			if (rnd(2 + probinc) != 0)
 			    break;
-			chat(y, x) = TRAP;
+			set_chat(y, x, TRAP);
 			if (!terse)
 			    addmsg("you found ");
 			if (on(player, ISHALU))
@@ -522,7 +635,7 @@ foundone:
 		    case ' ':
 			if (rnd(3 + probinc) != 0)
 			    break;
-			chat(y, x) = PASSAGE;
+			set_chat(y, x, PASSAGE);
 			goto foundone;
 		}
 	}
@@ -11,53 +11,341 @@
  * See the file LICENSE.TXT for full copyright and licensing information.
  */
 
+#include <stdlib.h>
+#include <string.h>
 #include <curses.h>
 #include "rogue.h"
 
 #define EMPTY 0
 #define DAEMON -1
-#define MAXDAEMONS 20
 
-#define _X_ { EMPTY }
+#define sched		(game->g_sched)
+#define slot(i)		(sched.s_slot[i])
+#define phase(type)	((type) == BEFORE ? 0 : 1)
 
-struct delayed_action d_list[MAXDAEMONS] = {
-    _X_, _X_, _X_, _X_, _X_, _X_, _X_, _X_, _X_, _X_,
-    _X_, _X_, _X_, _X_, _X_, _X_, _X_, _X_, _X_, _X_, 
+/*
+ * Everything that can be a fuse or a daemon.  Where it is in here is
+ * how it is known in a save file, so new ones go on the end.
+ */
+void (*d_funcs[NDFUNCS])() = {
+    NULL,
+    rollwand,
+    doctor,
+    stomach,
+    runners,
+    swander,
+    nohaste,
+    unconfuse,
+    unsee,
+    sight,
+    visuals,
+    come_down,
+    land,
+    (void (*)()) turn_see,
 };
 
+/*
+ * d_func_id:
+ *	Find where a function is in d_funcs[], or 0 if it isn't
+ */
+int
+d_func_id(void (*func)())
+{
+    register int i;
+
+    for (i = 1; i < NDFUNCS; i++)
+	if (d_funcs[i] == func)
+	    return i;
+    return 0;
+}
+
+/*
+ * d_grow:
+ *	Make room for more fuses and daemons
+ */
+static void
+d_grow()
+{
+    register int n, i;
+
+    n = (sched.s_nslot == 0 ? MAXDAEMONS : sched.s_nslot * 2);
+    if ((sched.s_slot = realloc(sched.s_slot,
+				n * sizeof *sched.s_slot)) == NULL
+      || (sched.s_used = realloc(sched.s_used,
+				 (n + 31) / 32 * sizeof *sched.s_used)) == NULL)
+	fatal("ran out of fuse slots\n");
+    for (i = 0; i < 2; i++)
+	if ((sched.s_fuse[i] = realloc(sched.s_fuse[i],
+				       n * sizeof *sched.s_fuse[i])) == NULL
+	  || (sched.s_daemon[i] = realloc(sched.s_daemon[i],
+					  n * sizeof *sched.s_daemon[i])) == NULL)
+	    fatal("ran out of fuse slots\n");
+    memset(&sched.s_slot[sched.s_nslot], 0,
+	   (n - sched.s_nslot) * sizeof *sched.s_slot);
+    for (i = (sched.s_nslot + 31) / 32; i < (n + 31) / 32; i++)
+	sched.s_used[i] = 0;
+    sched.s_nslot = n;
+}
+
 /*
  * d_slot:
- *	Find an empty slot in the daemon/fuse list
+ *	Find the lowest empty slot in the daemon/fuse list and take it
  */
-struct delayed_action *
+static int
 d_slot()
+{
+    register int w, b;
+
+    for (w = 0; w < (sched.s_nslot + 31) / 32; w++)
+	if (sched.s_used[w] != ~0U)
+	    break;
+    if (w * 32 >= sched.s_nslot)
+	d_grow();
+    for (b = 0; sched.s_used[w] & (1U << b); b++)
+	continue;
+    sched.s_used[w] |= 1U << b;
+    return w * 32 + b;
+}
+
+/*
+ * heap_less:
+ *	Does fuse a go off before fuse b?
+ */
+static bool
+heap_less(int a, int b)
+{
+    if (slot(a).d_time != slot(b).d_time)
+	return (bool)(slot(a).d_time < slot(b).d_time);
+    return (bool)(a < b);
+}
+
+/*
+ * heap_set:
+ *	Put a fuse at a place in a heap
+ */
+static void
+heap_set(int *heap, int where, int i)
+{
+    heap[where] = i;
+    slot(i).d_where = where;
+}
+
+/*
+ * heap_up:
+ *	Move a fuse up its heap until it is in order
+ */
+static void
+heap_up(int *heap, int where)
+{
+    register int i, up;
+
+    i = heap[where];
+    while (where > 0 && heap_less(i, heap[up = (where - 1) / 2]))
+    {
+	heap_set(heap, where, heap[up]);
+	where = up;
+    }
+    heap_set(heap, where, i);
+}
+
+/*
+ * heap_down:
+ *	Move a fuse down its heap until it is in order
+ */
+static void
+heap_down(int *heap, int n, int where)
+{
+    register int i, down;
+
+    i = heap[where];
+    while ((down = 2 * where + 1) < n)
+    {
+	if (down + 1 < n && heap_less(heap[down + 1], heap[down]))
+	    down++;
+	if (!heap_less(heap[down], i))
+	    break;
+	heap_set(heap, where, heap[down]);
+	where = down;
+    }
+    heap_set(heap, where, i);
+}
+
+/*
+ * heap_del:
+ *	Take a fuse out of its heap
+ */
+static void
+heap_del(int i)
+{
+    register int p, where, last, *heap;
+
+    p = phase(slot(i).d_type);
+    heap = sched.s_fuse[p];
+    where = slot(i).d_where;
+    if (where != --sched.s_nfuse[p])
+    {
+	last = heap[sched.s_nfuse[p]];
+	heap_set(heap, where, last);
+	heap_up(heap, where);
+	heap_down(heap, sched.s_nfuse[p], slot(last).d_where);
+    }
+    slot(i).d_where = -1;
+}
+
+/*
+ * d_after:
+ *	Find where the first daemon after a slot is in a phase's list
+ */
+static int
+d_after(int p, int i)
+{
+    register int lo, hi, mid;
+
+    lo = 0;
+    hi = sched.s_ndaemon[p];
+    while (lo < hi)
+    {
+	mid = (lo + hi) / 2;
+	if (sched.s_daemon[p][mid] <= i)
+	    lo = mid + 1;
+	else
+	    hi = mid;
+    }
+    return lo;
+}
+
+/*
+ * d_add:
+ *	Fill in a slot and put it where it belongs.  A fuse that has
+ *	no time left on it never goes off, so it stays out of the heap.
+ */
+static void
+d_add(int i, int type, void (*func)(), int arg, int time)
 {
     register struct delayed_action *dev;
+    register int p, where, *np, id;
 
-    for (dev = d_list; dev <= &d_list[MAXDAEMONS-1]; dev++)
-	if (dev->d_type == EMPTY)
-	    return dev;
-#ifdef MASTER
-    debug("Ran out of fuse slots");
-#endif
-    return NULL;
+    dev = &slot(i);
+    dev->d_type = type;
+    dev->d_func = func;
+    dev->d_arg = arg;
+    dev->d_time = time;
+    dev->d_where = -1;
+    p = phase(type);
+    if (time == DAEMON)
+    {
+	where = d_after(p, i);
+	memmove(&sched.s_daemon[p][where + 1], &sched.s_daemon[p][where],
+		(sched.s_ndaemon[p] - where) * sizeof (int));
+	sched.s_daemon[p][where] = i;
+	sched.s_ndaemon[p]++;
+    }
+    else if (time > 0)
+    {
+	dev->d_time = sched.s_ticks[p] + time;
+	heap_set(sched.s_fuse[p], sched.s_nfuse[p], i);
+	heap_up(sched.s_fuse[p], sched.s_nfuse[p]++);
+    }
+    /*
+     * Keep the slots for each function in order, so find_slot() gets
+     * the lowest one
+     */
+    id = d_func_id(func);
+    np = &sched.s_first[id];
+    while (*np != 0 && *np - 1 < i)
+	np = &slot(*np - 1).d_link;
+    dev->d_link = *np;
+    *np = i + 1;
+}
+
+/*
+ * d_del:
+ *	Empty a slot, taking it out of wherever it was kept
+ */
+static void
+d_del(int i)
+{
+    register struct delayed_action *dev;
+    register int p, where, *np;
+
+    dev = &slot(i);
+    p = phase(dev->d_type);
+    if (dev->d_time == DAEMON)
+    {
+	where = d_after(p, i) - 1;
+	memmove(&sched.s_daemon[p][where], &sched.s_daemon[p][where + 1],
+		(sched.s_ndaemon[p] - where - 1) * sizeof (int));
+	sched.s_ndaemon[p]--;
+    }
+    else if (dev->d_where >= 0)
+	heap_del(i);
+    np = &sched.s_first[d_func_id(dev->d_func)];
+    while (*np != i + 1)
+	np = &slot(*np - 1).d_link;
+    *np = dev->d_link;
+    dev->d_type = EMPTY;
+    sched.s_used[i / 32] &= ~(1U << (i % 32));
 }
 
 /*
  * find_slot:
  *	Find a particular slot in the table
  */
-struct delayed_action *
+static struct delayed_action *
 find_slot(void (*func)())
 {
-    register struct delayed_action *dev;
+    register int i;
 
-    for (dev = d_list; dev <= &d_list[MAXDAEMONS-1]; dev++)
-	if (dev->d_type != EMPTY && func == dev->d_func)
-	    return dev;
+    for (i = sched.s_first[d_func_id(func)]; i != 0; i = slot(i - 1).d_link)
+	if (slot(i - 1).d_func == func)
+	    return &slot(i - 1);
     return NULL;
 }
 
+/*
+ * d_left:
+ *	How many turns until a fuse goes off, or DAEMON for a daemon
+ */
+int
+d_left(struct delayed_action *dev)
+{
+    if (dev->d_time == DAEMON || dev->d_where < 0)
+	return dev->d_time;
+    return dev->d_time - sched.s_ticks[phase(dev->d_type)];
+}
+
+/*
+ * d_restore:
+ *	Put back a fuse or daemon read from a save file in its old slot
+ */
+void
+d_restore(int i, int type, void (*func)(), int arg, int time)
+{
+    while (i >= sched.s_nslot)
+	d_grow();
+    sched.s_used[i / 32] |= 1U << (i % 32);
+    d_add(i, type, func, arg, time);
+}
+
+/*
+ * free_sched:
+ *	Give back everything the fuses and daemons were kept in
+ */
+void
+free_sched()
+{
+    register int i;
+
+    free(sched.s_slot);
+    free(sched.s_used);
+    for (i = 0; i < 2; i++)
+    {
+	free(sched.s_fuse[i]);
+	free(sched.s_daemon[i]);
+    }
+    memset(&sched, 0, sizeof sched);
+}
+
 /*
  * start_daemon:
  *	Start a daemon, takes a function.
@@ -65,13 +353,7 @@ find_slot(void (*func)())
 void
 start_daemon(void (*func)(), int arg, int type)
 {
-    register struct delayed_action *dev;
-
-    dev = d_slot();
-    dev->d_type = type;
-    dev->d_func = func;
-    dev->d_arg = arg;
-    dev->d_time = DAEMON;
+    d_add(d_slot(), type, func, arg, DAEMON);
 }
 
 /*
@@ -88,7 +370,7 @@ kill_daemon(void (*func)())
     /*
      * Take it out of the list
      */
-    dev->d_type = EMPTY;
+    d_del((int) (dev - sched.s_slot));
 }
 
 /*
@@ -100,16 +382,22 @@ void
 do_daemons(int flag)
 {
     register struct delayed_action *dev;
+    register int p, where, i;
 
     /*
-     * Loop through the devil list
+     * Loop through the devil list.  A daemon can start or kill
+     * others, so after each one look again for the next slot.
      */
-    for (dev = d_list; dev <= &d_list[MAXDAEMONS-1]; dev++)
+    p = phase(flag);
+    for (where = 0; where < sched.s_ndaemon[p]; where = d_after(p, i))
+    {
+	i = sched.s_daemon[p][where];
+	dev = &slot(i);
 	/*
 	 * Executing each one, giving it the proper arguments
 	 */
-	if (dev->d_type == flag && dev->d_time == DAEMON)
-	    (*dev->d_func)(dev->d_arg);
+	(*dev->d_func)(dev->d_arg);
+    }
 }
 
 /*
@@ -119,13 +407,7 @@ do_daemons(int flag)
 void
 fuse(void (*func)(), int arg, int time, int type)
 {
-    register struct delayed_action *wire;
-
-    wire = d_slot();
-    wire->d_type = type;
-    wire->d_func = func;
-    wire->d_arg = arg;
-    wire->d_time = time;
+    d_add(d_slot(), type, func, arg, time);
 }
 
 /*
@@ -136,10 +418,20 @@ void
 lengthen(void (*func)(), int xtime)
 {
     register struct delayed_action *wire;
+    register int i, type, arg, time;
 
-    if ((wire = find_slot(func)) == NULL)
+    if ((wire = find_slot(func)) == NULL || wire->d_time == DAEMON)
 	return;
-    wire->d_time += xtime;
+    /*
+     * Put it back in the same slot with the new time
+     */
+    i = (int) (wire - sched.s_slot);
+    type = wire->d_type;
+    arg = wire->d_arg;
+    time = d_left(wire) + xtime;
+    d_del(i);
+    sched.s_used[i / 32] |= 1U << (i % 32);
+    d_add(i, type, func, arg, time);
 }
 
 /*
@@ -153,29 +445,36 @@ extinguish(void (*func)())
 
     if ((wire = find_slot(func)) == NULL)
 	return;
-    wire->d_type = EMPTY;
+    d_del((int) (wire - sched.s_slot));
 }
 
 /*
  * do_fuses:
- *	Decrement counters and start needed fuses
+ *	Count off a turn and start the fuses that are due
  */
 void
 do_fuses(int flag)
 {
     register struct delayed_action *wire;
+    register int p, i, *heap;
+    void (*func)();
+    int arg;
 
+    p = phase(flag);
+    heap = sched.s_fuse[p];
+    sched.s_ticks[p]++;
     /*
-     * Step though the list
+     * Starting things we want.  We also need to remove the fuse from
+     * the list once it has gone off.
      */
-    for (wire = d_list; wire <= &d_list[MAXDAEMONS-1]; wire++)
-	/*
-	 * Decrementing counters and starting things we want.  We also need
-	 * to remove the fuse from the list once it has gone off.
-	 */
-	if (flag == wire->d_type && wire->d_time > 0 && --wire->d_time == 0)
-	{
-	    wire->d_type = EMPTY;
-	    (*wire->d_func)(wire->d_arg);
-	}
+    while (sched.s_nfuse[p] > 0 && slot(heap[0]).d_time <= sched.s_ticks[p])
+    {
+	i = heap[0];
+	wire = &slot(i);
+	func = wire->d_func;
+	arg = wire->d_arg;
+	d_del(i);
+	(*func)(arg);
+	heap = sched.s_fuse[p];
+    }
 }
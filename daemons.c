@@ -59,7 +59,6 @@ swander()
  * rollwand:
  *	Called to roll to see if a wandering monster starts up
  */
-int between = 0;
 void
 rollwand()
 {
@@ -10,70 +10,26 @@
  * See the file LICENSE.TXT for full copyright and licensing information.
  */
 
+#include <stdlib.h>
+#include <string.h>
 #include <curses.h>
 #include "rogue.h"
 
-bool after;				/* True if we want after daemons */
-bool again;				/* Repeating the last command */
-int  noscore;				/* Was a wizard sometime */
-bool seenstairs;			/* Have seen the stairs (for lsd) */
-bool amulet = FALSE;			/* He found the amulet */
-bool door_stop = FALSE;			/* Stop running when we pass a door */
-bool fight_flush = FALSE;		/* True if toilet input */
-bool firstmove = FALSE;			/* First move after setting door_stop */
+TLOCAL struct game *game = NULL;		/* The game being played */
+
 bool got_ltc = FALSE;			/* We have gotten the local tty chars */
-bool has_hit = FALSE;			/* Has a "hit" message pending in msg */
 bool in_shell = FALSE;			/* True if executing a shell */
-bool inv_describe = TRUE;		/* Say which way items are being used */
-bool jump = FALSE;			/* Show running as series of jumps */
-bool kamikaze = FALSE;			/* to_death really to DEATH */
-bool lower_msg = FALSE;			/* Messages should start w/lower case */
-bool move_on = FALSE;			/* Next move shouldn't pick up items */
-bool msg_esc = FALSE;			/* Check for ESC from msg's --More-- */
-bool passgo = FALSE;			/* Follow passages */
-bool playing = TRUE;			/* True until he quits */
-bool q_comm = FALSE;			/* Are we executing a 'Q' command? */
-bool running = FALSE;			/* True if player is running */
-bool save_msg = TRUE;			/* Remember last msg */
-bool see_floor = TRUE;			/* Show the lamp illuminated floor */
-bool stat_msg = FALSE;			/* Should status() print as a msg() */
-bool terse = FALSE;			/* True if we should be short */
-bool to_death = FALSE;			/* Fighting is to the death! */
-bool tombstone = TRUE;			/* Print out tombstone at end */
 #ifdef MASTER
 int wizard = FALSE;			/* True if allows wizard commands */
 #endif
-bool pack_used[26] = {			/* Is the character used in the pack? */
-    FALSE, FALSE, FALSE, FALSE, FALSE, FALSE, FALSE, FALSE, FALSE,
-    FALSE, FALSE, FALSE, FALSE, FALSE, FALSE, FALSE, FALSE, FALSE,
-    FALSE, FALSE, FALSE, FALSE, FALSE, FALSE, FALSE, FALSE
-};
 
-char dir_ch;				/* Direction from last get_dir() call */
-char file_name[MAXSTR];			/* Save file name */
-char huh[MAXSTR];			/* The last message printed */
-char *p_colors[MAXPOTIONS];		/* Colors of the potions */
-char prbuf[2*MAXSTR];			/* buffer for sprintfs */
-char *r_stones[MAXRINGS];		/* Stone settings of the rings */
-char runch;				/* Direction player is running */
-char *s_names[MAXSCROLLS];		/* Names of the scrolls */
-char take;				/* Thing she is taking */
-char whoami[MAXSTR];			/* Name of player */
-char *ws_made[MAXSTICKS];		/* What sticks are made of */
-char *ws_type[MAXSTICKS];		/* Is it a wand or a staff */
 int  orig_dsusp;			/* Original dsusp char */
-char fruit[MAXSTR] =			/* Favorite fruit */
-		{ 's', 'l', 'i', 'm', 'e', '-', 'm', 'o', 'l', 'd', '\0' };
 char home[MAXSTR] = { '\0' };		/* User's home directory */
 char *inv_t_name[] = {
 	"Overwrite",
 	"Slow",
 	"Clear"
 };
-char l_last_comm = '\0';		/* Last last_comm */
-char l_last_dir = '\0';			/* Last last_dir */
-char last_comm = '\0';			/* Last command typed */
-char last_dir = '\0';			/* Last direction given */
 char *tr_name[] = {			/* Names of the traps */
 	"a trapdoor",
 	"an arrow trap",
@@ -85,17 +41,6 @@ char *tr_name[] = {			/* Names of the traps */
         "a mysterious trap"
 };
 
-
-int n_objs;				/* # items listed in inventory() call */
-int ntraps;				/* Number of traps on this level */
-int hungry_state = 0;			/* How hungry is he */
-int inpack = 0;				/* Number of things in pack */
-int inv_type = 0;			/* Type of inventory to use */
-int level = 1;				/* What level she is on */
-int max_hit;				/* Max damage done to her in to_death */
-int max_level;				/* Deepest player has gone */
-int mpos = 0;				/* Where cursor is on top line */
-int no_food = 0;			/* Number of levels without food */
 int a_class[MAXARMORS] = {		/* Armor class for each armor type */
 	8,	/* LEATHER */
 	7,	/* RING_MAIL */
@@ -107,18 +52,10 @@ int a_class[MAXARMORS] = {		/* Armor class for each armor type */
 	3,	/* PLATE_MAIL */
 };
 
-int count = 0;				/* Number of times to repeat command */
 FILE *scoreboard = NULL;	/* File descriptor for score file */
-int food_left;				/* Amount of food in hero's stomach */
-int lastscore = -1;			/* Score before this turn */
-int no_command = 0;			/* Number of turns asleep */
-int no_move = 0;			/* Number of turns held in place */
-int purse = 0;				/* How much gold he has */
-int quiet = 0;				/* Number of quiet turns */
-int vf_hit = 0;				/* Number of time flytrap has hit */
+int xlog = -1;			/* File descriptor for game log */
+int xlogbin = -1;		/* ... and for its binary twin */
 
-int dnum;				/* Dungeon number */
-int seed;				/* Random number seed */
 int e_levels[] = {
         10L,
 	20L,
@@ -143,49 +80,19 @@ int e_levels[] = {
 	 0L
 };
 
-coord delta;				/* Change indicated to get_dir() */
-coord oldpos;				/* Position before last look() call */
-coord stairs;				/* Location of staircase */
-
-PLACE places[MAXLINES*MAXCOLS];		/* level map */
-
-THING *cur_armor;			/* What he is wearing */
-THING *cur_ring[2];			/* Which rings are being worn */
-THING *cur_weapon;			/* Which weapon he is weilding */
-THING *l_last_pick = NULL;		/* Last last_pick */
-THING *last_pick = NULL;		/* Last object picked in get_item() */
-THING *lvl_obj = NULL;			/* List of objects on this level */
-THING *mlist = NULL;			/* List of monsters on the level */
-THING player;				/* His stats */
-					/* restart of game */
-
-WINDOW *hw = NULL;			/* used as a scratch window */
+TLOCAL WINDOW *hw = NULL;			/* used as a scratch window */
 
 #define INIT_STATS { 16, 0, 1, 10, 12, "1x4", 12 }
 
-struct stats max_stats = INIT_STATS;	/* The maximum for the player */
-
-struct room *oldrp;			/* Roomin(&oldpos) */
-struct room rooms[MAXROOMS];		/* One for each room -- A level */
-struct room passages[MAXPASS] =		/* One for each passage */
-{
-    { {0, 0}, {0, 0}, {0, 0}, 0, ISGONE|ISDARK, 0, {{0,0}} },
-    { {0, 0}, {0, 0}, {0, 0}, 0, ISGONE|ISDARK, 0, {{0,0}} },
-    { {0, 0}, {0, 0}, {0, 0}, 0, ISGONE|ISDARK, 0, {{0,0}} },
-    { {0, 0}, {0, 0}, {0, 0}, 0, ISGONE|ISDARK, 0, {{0,0}} },
-    { {0, 0}, {0, 0}, {0, 0}, 0, ISGONE|ISDARK, 0, {{0,0}} },
-    { {0, 0}, {0, 0}, {0, 0}, 0, ISGONE|ISDARK, 0, {{0,0}} },
-    { {0, 0}, {0, 0}, {0, 0}, 0, ISGONE|ISDARK, 0, {{0,0}} },
-    { {0, 0}, {0, 0}, {0, 0}, 0, ISGONE|ISDARK, 0, {{0,0}} },
-    { {0, 0}, {0, 0}, {0, 0}, 0, ISGONE|ISDARK, 0, {{0,0}} },
-    { {0, 0}, {0, 0}, {0, 0}, 0, ISGONE|ISDARK, 0, {{0,0}} },
-    { {0, 0}, {0, 0}, {0, 0}, 0, ISGONE|ISDARK, 0, {{0,0}} },
-    { {0, 0}, {0, 0}, {0, 0}, 0, ISGONE|ISDARK, 0, {{0,0}} }
-};
+static struct stats def_max_stats = INIT_STATS;	/* The maximum for the player */
 
+/*
+ * The tables below are copied into each new game, since the game
+ * writes on its own copies of them
+ */
 #define ___ 1
 #define XX 10
-struct monster monsters[26] =
+struct monster def_monsters[26] =
     {
 /* Name		 CARRY	FLAG    str, exp, lvl, amr, hpt, dmg */
 { "aquator",	   0,	ISMEAN,	{ XX, 20,   5,   2, ___, "0x0/0x0" } },
@@ -220,7 +127,7 @@ struct monster monsters[26] =
 #undef ___
 #undef XX
 
-struct obj_info things[NUMTHINGS] = {
+struct obj_info def_things[NUMTHINGS] = {
     { 0,			26 },	/* potion */
     { 0,			36 },	/* scroll */
     { 0,			16 },	/* food */
@@ -230,7 +137,7 @@ struct obj_info things[NUMTHINGS] = {
     { 0,			 4 },	/* stick */
 };
 
-struct obj_info arm_info[MAXARMORS] = {
+struct obj_info def_arm_info[MAXARMORS] = {
     { "leather armor",		 20,	 20, NULL, FALSE },
     { "ring mail",		 15,	 25, NULL, FALSE },
     { "studded leather armor",	 15,	 20, NULL, FALSE },
@@ -240,7 +147,7 @@ struct obj_info arm_info[MAXARMORS] = {
     { "banded mail",		 10,	 90, NULL, FALSE },
     { "plate mail",		  5,	150, NULL, FALSE },
 };
-struct obj_info pot_info[MAXPOTIONS] = {
+struct obj_info def_pot_info[MAXPOTIONS] = {
     { "confusion",		 7,   5, NULL, FALSE },
     { "hallucination",		 8,   5, NULL, FALSE },
     { "poison",			 8,   5, NULL, FALSE },
@@ -256,7 +163,7 @@ struct obj_info pot_info[MAXPOTIONS] = {
     { "blindness",		 5,   5, NULL, FALSE },
     { "levitation",		 6,  75, NULL, FALSE },
 };
-struct obj_info ring_info[MAXRINGS] = {
+struct obj_info def_ring_info[MAXRINGS] = {
     { "protection",		 9, 400, NULL, FALSE },
     { "add strength",		 9, 400, NULL, FALSE },
     { "sustain strength",	 5, 280, NULL, FALSE },
@@ -272,7 +179,7 @@ struct obj_info ring_info[MAXRINGS] = {
     { "stealth",		 7, 470, NULL, FALSE },
     { "maintain armor",		 5, 380, NULL, FALSE },
 };
-struct obj_info scr_info[MAXSCROLLS] = {
+struct obj_info def_scr_info[MAXSCROLLS] = {
     { "monster confusion",		 7, 140, NULL, FALSE },
     { "magic mapping",			 4, 150, NULL, FALSE },
     { "hold monster",			 2, 180, NULL, FALSE },
@@ -292,7 +199,7 @@ struct obj_info scr_info[MAXSCROLLS] = {
     { "aggravate monsters",		 3,  20, NULL, FALSE },
     { "protect armor",			 2, 250, NULL, FALSE },
 };
-struct obj_info weap_info[MAXWEAPONS + 1] = {
+struct obj_info def_weap_info[MAXWEAPONS + 1] = {
     { "mace",				11,   8, NULL, FALSE },
     { "long sword",			11,  15, NULL, FALSE },
     { "short bow",			12,  15, NULL, FALSE },
@@ -304,7 +211,7 @@ struct obj_info weap_info[MAXWEAPONS + 1] = {
     { "spear",				12,   5, NULL, FALSE },
     { NULL, 0 },	/* DO NOT REMOVE: fake entry for dragon's breath */
 };
-struct obj_info ws_info[MAXSTICKS] = {
+struct obj_info def_ws_info[MAXSTICKS] = {
     { "light",			12, 250, NULL, FALSE },
     { "invisibility",		 6,   5, NULL, FALSE },
     { "lightning",		 3, 330, NULL, FALSE },
@@ -389,3 +296,78 @@ struct h_list helpstr[] = {
     {'v',	"	print version number",			TRUE},
     {0,		NULL }
 };
+
+/*
+ * new_game:
+ *	Allocate a game and set everything in it to the way it is at
+ *	the start of play
+ */
+struct game *
+new_game()
+{
+    struct game *g;
+    struct room *rp;
+    struct monster *mp;
+
+    if ((g = (struct game *) calloc(1, sizeof (struct game))) == NULL)
+	return NULL;
+    g->g_nmslot = 32;
+    if ((g->g_mslot = (THING **) calloc(g->g_nmslot, sizeof (THING *))) == NULL)
+    {
+	free(g);
+	return NULL;
+    }
+    g->g_inv_describe = TRUE;
+    g->g_playing = TRUE;
+    g->g_save_msg = TRUE;
+    g->g_see_floor = TRUE;
+    g->g_frame_time = 100;
+    g->g_tombstone = TRUE;
+    strcpy(g->g_fruit, "slime-mold");
+    g->g_lastscore = -1;
+    g->g_level = 1;
+    g->g_group = 2;
+    g->g_stat.s_pur = -1;
+    g->g_maxlen = -1;
+    g->g_max_stats = def_max_stats;
+    for (rp = g->g_passages; rp < &g->g_passages[MAXPASS]; rp++)
+	rp->r_flags = ISGONE|ISDARK;
+    memcpy(g->g_monsters, def_monsters, sizeof g->g_monsters);
+    for (mp = g->g_monsters; mp < &g->g_monsters[26]; mp++)
+	set_dice(&mp->m_stats.s_dice, mp->m_stats.s_dmg);
+    set_dice(&g->g_max_stats.s_dice, g->g_max_stats.s_dmg);
+    memcpy(g->g_things, def_things, sizeof g->g_things);
+    memcpy(g->g_arm_info, def_arm_info, sizeof g->g_arm_info);
+    memcpy(g->g_pot_info, def_pot_info, sizeof g->g_pot_info);
+    memcpy(g->g_ring_info, def_ring_info, sizeof g->g_ring_info);
+    memcpy(g->g_scr_info, def_scr_info, sizeof g->g_scr_info);
+    memcpy(g->g_weap_info, def_weap_info, sizeof g->g_weap_info);
+    memcpy(g->g_ws_info, def_ws_info, sizeof g->g_ws_info);
+    return g;
+}
+
+/*
+ * free_game:
+ *	Throw away a game and everything it has allocated
+ */
+void
+free_game(struct game *g)
+{
+    struct game *og;
+    int i;
+
+    og = game;
+    game = g;
+    free_things();
+    free_sched();
+    free_screen();
+    watch_close();
+    rec_close();
+    replay_close();
+    for (i = 0; i < MAXSCROLLS; i++)
+	if (s_names[i] != NULL)
+	    free(s_names[i]);
+    free(g->g_mslot);
+    game = (og == g ? NULL : og);
+    free(g);
+}
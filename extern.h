@@ -106,7 +106,6 @@
 #define MAXLINES	32	/* maximum number of screen lines used */
 #define MAXCOLS		80	/* maximum number of screen columns used */
 
-#define RN		(((seed = seed*11109+13849) >> 16) & 0xffff)
 #ifdef CTRL
 #undef CTRL
 #endif
@@ -118,7 +117,6 @@
 
 extern bool	got_ltc, in_shell;
 extern int	wizard;
-extern char	fruit[], prbuf[], whoami[];
 extern int orig_dsusp;
 extern FILE	*scoreboard;
 
@@ -163,29 +161,47 @@ char	*type_name(int type);
 int	checkout();
 #endif
 
+int	md_child_done(int pid, int wait);
+void	md_child_exit(int status);
 int	md_chmod(char *filename, int mode);
+int	md_close(int fd);
 char	*md_crypt(char *key, char *salt);
 int	md_dsuspchar();
 int	md_erasechar();
+int	md_fork();
 char	*md_gethomedir();
 char	*md_getusername();
+void	*md_mapfile(char *file, size_t size);
 int	md_getuid();
 char	*md_getpass(char *prompt);
 int	md_getpid();
 char	*md_getrealname(int uid);
 void	md_init();
 int	md_killchar();
+int	md_lockfile(int fd, int timeout);
+long	md_millis();
+void	md_now(long *secp, long *usecp);
 void	md_normaluser();
+int	md_pipe(int fds[2]);
+int	md_pipe_wait(int fd);
+int	md_openappend(char *file);
+int	md_outqueue();
 void	md_raw_standout();
 void	md_raw_standend();
+int	md_read(int fd, void *buf, size_t size);
 int	md_readchar();
+int	md_rename(char *from, char *to);
 int	md_setdsuspchar(int c);
 int	md_shellescape();
 void	md_sleep(int s);
 int	md_suspchar();
+int	md_truncate(int fd, long size);
 int	md_hasclreol();
 int	md_unlink(char *file);
 int	md_unlink_open_file(char *file, FILE *inf);
+int	md_write(int fd, void *buf, size_t size);
+void	md_unlockfile(int fd);
+void	md_unmapfile(void *addr, size_t size);
 void md_tstpsignal();
 void md_tstphold();
 void md_tstpresume();
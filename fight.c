@@ -268,6 +268,8 @@ attack(THING *mp)
 		     */
 		    player.t_flags |= ISHELD;
 		    sprintf(monsters['F'-'A'].m_stats.s_dmg,"%dx1", ++vf_hit);
+		    set_dice(&monsters['F'-'A'].m_stats.s_dice,
+			monsters['F'-'A'].m_stats.s_dmg);
 		    if (--pstats.s_hpt <= 0)
 			death('F');
 		when 'L':
@@ -350,7 +352,7 @@ set_mname(THING *tp)
 {
     int ch;
     char *mname;
-    static char tbuf[MAXSTR] = { 't', 'h', 'e', ' ' };
+    static TLOCAL char tbuf[MAXSTR] = { 't', 'h', 'e', ' ' };
 
     if (!see_monst(tp) && !on(player, SEEMONST))
 	return (terse ? "it" : "something");
@@ -391,8 +393,8 @@ bool
 roll_em(THING *thatt, THING *thdef, THING *weap, bool hurl)
 {
     register struct stats *att, *def;
-    register char *cp;
-    register int ndice, nsides, def_arm;
+    register struct dice *dc;
+    register int i, def_arm;
     register bool did_hit = FALSE;
     register int hplus;
     register int dplus;
@@ -402,7 +404,7 @@ roll_em(THING *thatt, THING *thdef, THING *weap, bool hurl)
     def = &thdef->t_stats;
     if (weap == NULL)
     {
-	cp = att->s_dmg;
+	dc = &att->s_dice;
 	dplus = 0;
 	hplus = 0;
     }
@@ -421,18 +423,18 @@ roll_em(THING *thatt, THING *thdef, THING *weap, bool hurl)
 	    else if (ISRING(RIGHT, R_ADDHIT))
 		hplus += cur_ring[RIGHT]->o_arm;
 	}
-	cp = weap->o_damage;
+	dc = &weap->o_dice;
 	if (hurl)
 	{
 	    if ((weap->o_flags&ISMISL) && cur_weapon != NULL &&
 	      cur_weapon->o_which == weap->o_launch)
 	    {
-		cp = weap->o_hurldmg;
+		dc = &weap->o_hurldice;
 		hplus += cur_weapon->o_hplus;
 		dplus += cur_weapon->o_dplus;
 	    }
 	    else if (weap->o_launch < 0)
-		cp = weap->o_hurldmg;
+		dc = &weap->o_hurldice;
 	}
     }
     /*
@@ -451,16 +453,14 @@ roll_em(THING *thatt, THING *thdef, THING *weap, bool hurl)
 	if (ISRING(RIGHT, R_PROTECT))
 	    def_arm -= cur_ring[RIGHT]->o_arm;
     }
-    while(cp != NULL && *cp != '\0')
+    for (i = 0; i < dc->dc_cnt; i++)
     {
-	ndice = atoi(cp);
-	if ((cp = strchr(cp, 'x')) == NULL)
-	    break;
-	nsides = atoi(++cp);
 	if (swing(att->s_lvl, def_arm, hplus + str_plus[att->s_str]))
 	{
-	    int proll;
+	    int proll, ndice, nsides;
 
+	    ndice = dc->dc_dice[i].d_num;
+	    nsides = dc->dc_dice[i].d_sides;
 	    proll = roll(ndice, nsides);
 #ifdef MASTER
 	    if (ndice + nsides > 0 && proll <= 0)
@@ -470,11 +470,35 @@ roll_em(THING *thatt, THING *thdef, THING *weap, bool hurl)
 	    def->s_hpt -= max(0, damage);
 	    did_hit = TRUE;
 	}
+    }
+    return did_hit;
+}
+
+/*
+ * set_dice:
+ *	Compile a damage string into the dice roll_em() uses.  Anything
+ *	that sets a damage string calls this right after.
+ */
+void
+set_dice(struct dice *dc, char *str)
+{
+    register char *cp;
+    int ndice;
+
+    dc->dc_cnt = 0;
+    cp = str;
+    while (*cp != '\0' && dc->dc_cnt < MAXDICE)
+    {
+	ndice = atoi(cp);
+	if ((cp = strchr(cp, 'x')) == NULL)
+	    break;
+	dc->dc_dice[dc->dc_cnt].d_num = (short) ndice;
+	dc->dc_dice[dc->dc_cnt].d_sides = (short) atoi(++cp);
+	dc->dc_cnt++;
 	if ((cp = strchr(cp, '/')) == NULL)
 	    break;
 	cp++;
     }
-    return did_hit;
 }
 
 /*
@@ -484,7 +508,7 @@ roll_em(THING *thatt, THING *thdef, THING *weap, bool hurl)
 char *
 prname(char *mname, bool upper)
 {
-    static char tbuf[MAXSTR];
+    static TLOCAL char tbuf[MAXSTR];
 
     *tbuf = '\0';
     if (mname == 0)
@@ -608,9 +632,10 @@ remove_mon(coord *mp, THING *tp, bool waskill)
 	else
 	    discard(obj);
     }
-    moat(mp->y, mp->x) = NULL;
+    set_moat(mp->y, mp->x, NULL);
     mvaddch(mp->y, mp->x, tp->t_oldch);
     detach(mlist, tp);
+    free_slot(tp);
     if (on(*tp, ISTARGET))
     {
 	kamikaze = FALSE;
@@ -641,6 +666,7 @@ killed(THING *tp, bool pr)
 	    player.t_flags &= ~ISHELD;
 	    vf_hit = 0;
 	    strcpy(monsters['F'-'A'].m_stats.s_dmg, "000x0");
+	    set_dice(&monsters['F'-'A'].m_stats.s_dice, "000x0");
 	when 'L':
 	{
 	    THING *gold;
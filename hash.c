@@ -0,0 +1,258 @@
+/*
+ * A hash of the state of the game, cheap enough to work out every
+ * turn: for checking a replay is still on course, and for a bot to
+ * tell whether it has been in the same spot before.
+ *
+ * The map and the things on the level are hashed Zobrist fashion.
+ * Each thing that can be somewhere (a character at a place on the
+ * map, a monster at a place, an object at a place, an object in the
+ * pack) has a key of its own, and the hash is the sum of the keys of
+ * everything that is there now.  When one of them changes, its old
+ * key comes out and its new one goes in, so the hash never has to be
+ * worked out again from scratch.  The keys are made from what they
+ * stand for instead of being kept in a table, and they are added
+ * instead of exclusive or'ed so two things in the pack that are just
+ * alike don't cancel each other out.
+ *
+ * A key only covers what a thing is and where it is.  Its own numbers
+ * (a monster's hit points and flags, an object's count, pluses,
+ * charges and flags) change in far too many places to follow, so,
+ * like the numbers that change every turn anyway (the hero, the random
+ * numbers and so on), they are mixed in when the hash is asked for.
+ * There are never more than a few dozen things, so that is cheap next
+ * to the map.
+ *
+ * Rogue: Exploring the Dungeons of Doom
+ * Copyright (C) 1980-1983, 1985, 1999 Michael Toy, Ken Arnold and Glenn Wichman
+ * All rights reserved.
+ *
+ * See the file LICENSE.TXT for full copyright and licensing information.
+ */
+
+#include <curses.h>
+#include "rogue.h"
+
+/*
+ * What a key stands for
+ */
+#define HK_CELL		1		/* A character on the map */
+#define HK_MONST	2		/* A monster on the level */
+#define HK_OBJ		3		/* An object on the floor */
+#define HK_PACK		4		/* An object in the pack */
+
+#define MIX(h, v)	(h = h_mix(h ^ (hash_t) (v)))
+
+/*
+ * h_mix:
+ *	Scramble a number (the splitmix64 finalizer)
+ */
+static hash_t
+h_mix(hash_t x)
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+/*
+ * h_key:
+ *	The key for one thing being somewhere
+ */
+static hash_t
+h_key(int kind, int what, int which, int where)
+{
+    return h_mix(((hash_t) kind << 56) | ((hash_t) (what & 0xff) << 48)
+	| ((hash_t) (which & 0xffff) << 32) | (hash_t) (unsigned int) where);
+}
+
+/*
+ * h_thing:
+ *	The key for a thing on a list, or 0 if the list isn't hashed
+ */
+static hash_t
+h_thing(THING **list, THING *tp)
+{
+    if (list == &mlist)
+	return h_key(HK_MONST, tp->t_type, 0, INDEX(tp->t_pos.y, tp->t_pos.x));
+    if (list == &lvl_obj)
+	return h_key(HK_OBJ, tp->o_type, tp->o_which,
+	    INDEX(tp->o_pos.y, tp->o_pos.x));
+    if (list == &pack)
+	return h_key(HK_PACK, tp->o_type, tp->o_which, 0);
+    return 0;
+}
+
+/*
+ * h_sum:
+ *	Add up the keys for the map and everything on the lists
+ */
+static hash_t
+h_sum()
+{
+    hash_t h;
+    THING *tp;
+    int pp;
+
+    h = 0;
+    for (pp = 0; pp < MAXLINES * MAXCOLS; pp++)
+	h += h_key(HK_CELL, places.p_ch[pp], 0, pp);
+    for (tp = mlist; tp != NULL; tp = next(tp))
+	h += h_thing(&mlist, tp);
+    for (tp = lvl_obj; tp != NULL; tp = next(tp))
+	h += h_thing(&lvl_obj, tp);
+    for (tp = pack; tp != NULL; tp = next(tp))
+	h += h_thing(&pack, tp);
+    return h;
+}
+
+/*
+ * h_own:
+ *	Add up the keys for the things on a list, each mixed with its
+ *	own numbers
+ */
+static hash_t
+h_own(THING **list)
+{
+    hash_t h, v;
+    THING *tp;
+
+    h = 0;
+    for (tp = *list; tp != NULL; tp = next(tp))
+    {
+	v = h_thing(list, tp);
+	if (list == &mlist)
+	{
+	    MIX(v, tp->t_flags);
+	    MIX(v, tp->t_stats.s_hpt);
+	}
+	else
+	{
+	    MIX(v, tp->o_count);
+	    MIX(v, tp->o_hplus);
+	    MIX(v, tp->o_dplus);
+	    MIX(v, tp->o_arm);
+	    MIX(v, tp->o_flags);
+	}
+	h += v;
+    }
+    return h;
+}
+
+/*
+ * h_fold:
+ *	Mix in the rest of the game
+ */
+static hash_t
+h_fold(hash_t h)
+{
+    struct rng *rp = &game->g_rng;
+    struct stats *sp = &pstats;
+
+    MIX(h, h_own(&mlist) + h_own(&lvl_obj) + h_own(&pack));
+    MIX(h, rp->r_engine);
+    MIX(h, rp->r_seed);
+    MIX(h, rp->r_s[0]);
+    MIX(h, rp->r_s[1]);
+    MIX(h, rp->r_s[2]);
+    MIX(h, rp->r_s[3]);
+    MIX(h, turns);
+    MIX(h, level);
+    MIX(h, max_level);
+    MIX(h, purse);
+    MIX(h, food_left);
+    MIX(h, INDEX(hero.y, hero.x));
+    MIX(h, player.t_flags);
+    MIX(h, sp->s_str);
+    MIX(h, sp->s_exp);
+    MIX(h, sp->s_lvl);
+    MIX(h, sp->s_arm);
+    MIX(h, sp->s_hpt);
+    MIX(h, sp->s_maxhp);
+    return h;
+}
+
+/*
+ * hash_game:
+ *	The hash of the game as it is now
+ */
+hash_t
+hash_game()
+{
+    return h_fold(game->g_hash);
+}
+
+/*
+ * hash_full:
+ *	The same, but worked out from scratch
+ */
+hash_t
+hash_full()
+{
+    return h_fold(h_sum());
+}
+
+/*
+ * hash_reset:
+ *	Start the hash over, after the level has been made or the game
+ *	read back in all at once
+ */
+void
+hash_reset()
+{
+    game->g_hash = h_sum();
+}
+
+/*
+ * hash_attach:
+ *	A thing has gone on a list
+ */
+void
+hash_attach(THING **list, THING *tp)
+{
+    game->g_hash += h_thing(list, tp);
+}
+
+/*
+ * hash_detach:
+ *	A thing has come off a list
+ */
+void
+hash_detach(THING **list, THING *tp)
+{
+    game->g_hash -= h_thing(list, tp);
+}
+
+/*
+ * set_chat:
+ *	Change what is at a place on the map
+ */
+void
+set_chat(int y, int x, char ch)
+{
+    int pp;
+
+    pp = INDEX(y, x);
+    game->g_hash += h_key(HK_CELL, ch, 0, pp)
+	- h_key(HK_CELL, places.p_ch[pp], 0, pp);
+    places.p_ch[pp] = ch;
+}
+
+/*
+ * hash_turn:
+ *	Take the hash at the end of a turn.  When checking, it has to
+ *	match what hash_full() gets; if it doesn't, something changed
+ *	the game behind the hash's back.
+ */
+void
+hash_turn()
+{
+    game->g_hash_sum = hash_game();
+    if (game->g_hash_check && game->g_hash_sum != hash_full())
+    {
+	if (game->g_hash_bad++ == 0)
+	    game->g_hash_when = turns;
+	hash_reset();
+	game->g_hash_sum = hash_game();
+    }
+}
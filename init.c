@@ -230,7 +230,7 @@ char *metal[] = {
 int cNMETAL = NMETAL;
 #define MAX3(a,b,c)	(a > b ? (a > c ? a : c) : (b > c ? b : c))
 
-static bool used[MAX3(NCOLORS, NSTONES, NWOOD)];
+static TLOCAL bool used[MAX3(NCOLORS, NSTONES, NWOOD)];
 
 /*
  * init_colors:
@@ -320,7 +320,7 @@ init_materials()
 {
     register int i, j;
     register char *str;
-    static bool metused[NMETAL];
+    static TLOCAL bool metused[NMETAL];
 
     for (i = 0; i < NWOOD; i++)
 	used[i] = FALSE;
@@ -14,10 +14,8 @@
  * msg:
  *	Display a message at the top of the screen.
  */
-#define MAXMSG	(NUMCOLS - sizeof "--More--")
-
-static char msgbuf[2*MAXMSG+1];
-static int newpos = 0;
+#define msgbuf		(game->g_msgbuf)
+#define newpos		(game->g_newpos)
 
 /* VARARGS1 */
 int
@@ -76,6 +74,15 @@ endmsg()
 	look(FALSE);
 	mvaddstr(0, mpos, "--More--");
 	refresh();
+#ifdef ROGUE_SIM
+	/*
+	 * Unless the feed is a real keystroke log, nobody is watching,
+	 * so don't wait for them to read it
+	 */
+	if (!game->g_sim_wait)
+	    ;
+	else
+#endif
 	if (!msg_esc)
 	    wait_for(' ');
 	else
@@ -113,7 +120,7 @@ endmsg()
 void
 doadd(char *fmt, va_list args)
 {
-    static char buf[MAXSTR];
+    static TLOCAL char buf[MAXSTR];
 
     /*
      * Do the printf into buf
@@ -153,6 +160,7 @@ readchar()
     char ch;
 
     ch = (char) md_readchar();
+    replay_key(ch);
 
     if (ch == 3)
     {
@@ -171,14 +179,7 @@ void
 status()
 {
     register int oy, ox, temp;
-    static int hpwidth = 0;
-    static int s_hungry = 0;
-    static int s_lvl = 0;
-    static int s_pur = -1;
-    static int s_hp = 0;
-    static int s_arm = 0;
-    static str_t s_str = 0;
-    static int s_exp = 0;
+    register struct stat_cache *sc = &game->g_stat;
     static char *state_name[] =
     {
 	"", "Hungry", "Weak", "Faint"
@@ -189,40 +190,40 @@ status()
      * bother.
      */
     temp = (cur_armor != NULL ? cur_armor->o_arm : pstats.s_arm);
-    if (s_hp == pstats.s_hpt && s_exp == pstats.s_exp && s_pur == purse
-	&& s_arm == temp && s_str == pstats.s_str && s_lvl == level
-	&& s_hungry == hungry_state
+    if (sc->s_hp == pstats.s_hpt && sc->s_exp == pstats.s_exp && sc->s_pur == purse
+	&& sc->s_arm == temp && sc->s_str == pstats.s_str && sc->s_lvl == level
+	&& sc->s_hungry == hungry_state
 	&& !stat_msg
 	)
 	    return;
 
-    s_arm = temp;
+    sc->s_arm = temp;
 
     getyx(stdscr, oy, ox);
-    if (s_hp != max_hp)
+    if (sc->s_hp != max_hp)
     {
 	temp = max_hp;
-	s_hp = max_hp;
-	for (hpwidth = 0; temp; hpwidth++)
+	sc->s_hp = max_hp;
+	for (sc->hpwidth = 0; temp; sc->hpwidth++)
 	    temp /= 10;
     }
 
     /*
      * Save current status
      */
-    s_lvl = level;
-    s_pur = purse;
-    s_hp = pstats.s_hpt;
-    s_str = pstats.s_str;
-    s_exp = pstats.s_exp; 
-    s_hungry = hungry_state;
+    sc->s_lvl = level;
+    sc->s_pur = purse;
+    sc->s_hp = pstats.s_hpt;
+    sc->s_str = pstats.s_str;
+    sc->s_exp = pstats.s_exp; 
+    sc->s_hungry = hungry_state;
 
     if (stat_msg)
     {
 	move(0, 0);
         msg("Level: %d  Gold: %-5d  Hp: %*d(%*d)  Str: %2d(%d)  Arm: %-2d  Exp: %d/%ld  %s",
-	    level, purse, hpwidth, pstats.s_hpt, hpwidth, max_hp, pstats.s_str,
-	    max_stats.s_str, 10 - s_arm, pstats.s_lvl, pstats.s_exp,
+	    level, purse, sc->hpwidth, pstats.s_hpt, sc->hpwidth, max_hp, pstats.s_str,
+	    max_stats.s_str, 10 - sc->s_arm, pstats.s_lvl, pstats.s_exp,
 	    state_name[hungry_state]);
     }
     else
@@ -230,8 +231,8 @@ status()
 	move(STATLINE, 0);
                 
         printw("Level: %d  Gold: %-5d  Hp: %*d(%*d)  Str: %2d(%d)  Arm: %-2d  Exp: %d/%d  %s",
-	    level, purse, hpwidth, pstats.s_hpt, hpwidth, max_hp, pstats.s_str,
-	    max_stats.s_str, 10 - s_arm, pstats.s_lvl, pstats.s_exp,
+	    level, purse, sc->hpwidth, pstats.s_hpt, sc->hpwidth, max_hp, pstats.s_str,
+	    max_stats.s_str, 10 - sc->s_arm, pstats.s_lvl, pstats.s_exp,
 	    state_name[hungry_state]);
     }
 
@@ -248,6 +249,10 @@ wait_for(int ch)
 {
     register char c;
 
+#ifdef ROGUE_SIM
+    if (!game->g_sim_wait)
+	return;
+#endif
     if (ch == '\n')
         while ((c = readchar()) != '\n' && c != '\r')
 	    continue;
@@ -11,13 +11,10 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <curses.h>
 #include "rogue.h"
 
-#ifdef MASTER
-int total = 0;			/* total dynamic memory bytes */
-#endif
-
 /*
  * detach:
  *	takes an item out of whatever linked list it might be in
@@ -26,6 +23,7 @@ int total = 0;			/* total dynamic memory bytes */
 void
 _detach(THING **list, THING *item)
 {
+    hash_detach(list, item);
     if (*list == item)
 	*list = next(item);
     if (prev(item) != NULL)
@@ -56,6 +54,7 @@ _attach(THING **list, THING *item)
 	item->l_prev = NULL;
     }
     *list = item;
+    hash_attach(list, item);
 }
 
 /*
@@ -84,10 +83,12 @@ _free_list(THING **ptr)
 void
 discard(THING *item)
 {
-#ifdef MASTER
-    total--;
-#endif
-    free((char *) item);
+    struct arena *ap;
+
+    ap = &game->g_arena[game->g_cur_arena];
+    item->l_next = ap->a_free;
+    ap->a_free = item;
+    game->g_in_use--;
 }
 
 /*
@@ -98,16 +99,116 @@ THING *
 new_item()
 {
     THING *item;
+    struct arena *ap;
+    struct slab *sp;
 
-#ifdef MASTER
-    if ((item = calloc(1, sizeof *item)) == NULL)
-	msg("ran out of memory after %d items", total);
+    ap = &game->g_arena[game->g_cur_arena];
+    if ((item = ap->a_free) != NULL)
+	ap->a_free = next(item);
     else
-	total++;
-#else
-    item = calloc(1, sizeof *item);
-#endif
-    item->l_next = NULL;
-    item->l_prev = NULL;
+    {
+	if (ap->a_cur == NULL || ap->a_used == SLABSIZE)
+	{
+	    /*
+	     * Move on to the next slab, reusing one left from an earlier
+	     * level if there is one
+	     */
+	    if (ap->a_cur != NULL && ap->a_cur->s_next != NULL)
+		sp = ap->a_cur->s_next;
+	    else if (ap->a_cur == NULL && ap->a_slabs != NULL)
+		sp = ap->a_slabs;
+	    else
+	    {
+		if ((sp = malloc(sizeof *sp)) == NULL)
+		    fatal("ran out of memory\n");
+		sp->s_next = NULL;
+		if (ap->a_cur == NULL)
+		    ap->a_slabs = sp;
+		else
+		    ap->a_cur->s_next = sp;
+		game->g_slabs++;
+	    }
+	    ap->a_cur = sp;
+	    ap->a_used = 0;
+	}
+	item = &ap->a_cur->s_thing[ap->a_used++];
+    }
+    if (++game->g_in_use > game->g_most_in_use)
+	game->g_most_in_use = game->g_in_use;
+    memset(item, 0, sizeof *item);
     return item;
 }
+
+/*
+ * drop_level:
+ *	Throw away everything on the level in one go.  What the hero is
+ *	carrying is moved over to the other arena first, and anything
+ *	that points into his pack is pointed at the copies.
+ */
+void
+drop_level()
+{
+    struct arena *ap;
+    THING *obj, *nobj, *npack, *last, *pick, *l_pick;
+    int i;
+
+    pick = last_pick;
+    l_pick = l_last_pick;
+    last_pick = l_last_pick = NULL;
+    ap = &game->g_arena[game->g_cur_arena];
+    game->g_cur_arena ^= 1;
+    game->g_in_use = 0;
+    npack = last = NULL;
+    for (obj = pack; obj != NULL; obj = next(obj))
+    {
+	nobj = new_item();
+	*nobj = *obj;
+	nobj->l_next = NULL;
+	nobj->l_prev = last;
+	if (last == NULL)
+	    npack = nobj;
+	else
+	    last->l_next = nobj;
+	last = nobj;
+	if (cur_armor == obj)
+	    cur_armor = nobj;
+	if (cur_weapon == obj)
+	    cur_weapon = nobj;
+	for (i = LEFT; i <= RIGHT; i++)
+	    if (cur_ring[i] == obj)
+		cur_ring[i] = nobj;
+	if (pick == obj)
+	    last_pick = nobj;
+	if (l_pick == obj)
+	    l_last_pick = nobj;
+    }
+    pack = npack;
+    mlist = NULL;
+    lvl_obj = NULL;
+    ap->a_cur = NULL;
+    ap->a_used = 0;
+    ap->a_free = NULL;
+}
+
+/*
+ * free_things:
+ *	Give back every slab the game has
+ */
+void
+free_things()
+{
+    struct slab *sp, *nsp;
+    int i;
+
+    for (i = 0; i < 2; i++)
+    {
+	for (sp = game->g_arena[i].a_slabs; sp != NULL; sp = nsp)
+	{
+	    nsp = sp->s_next;
+	    free(sp);
+	}
+	memset(&game->g_arena[i], 0, sizeof game->g_arena[i]);
+    }
+    game->g_in_use = 0;
+    game->g_slabs = 0;
+}
@@ -14,11 +14,18 @@
  * The various tuneable defines are:
  *
  *	SCOREFILE	Where/if the score file should live.
+ *	XLOGFILE	Where/if the log of every game played should live
+ *			(default rogue.xlog when there is a score file).
+ *			A name with no directory goes in the score
+ *			file's directory.
+ *	XLOGBIN		Where the same log goes in binary (default
+ *			XLOGFILE with .bin on the end).
  *	ALLSCORES	Score file is top ten scores, not top ten
  *			players.  This is only useful when only a few
  *			people will be playing; otherwise the score file
  *			gets hogged by just a few people.
- *	NUMSCORES	Number of scores in the score file (default 10).
+ *	NUMSCORES	Number of scores shown from the score file
+ *			(default 10).
  *	NUMNAME		String version of NUMSCORES (first character
  *			should be capitalized) (default "Ten").
  *	MAXLOAD		What (if any) the maximum load average should be
@@ -36,6 +43,9 @@
  *      UTMP		If so, where does the user list hide?
  *	CHECKTIME	How often/if it should check during the game
  *			for high load average.
+ *	MAXSCORES	Most scores the score file keeps (default 50000).
+ *	LOCKTIME	How long to wait for someone else to finish
+ *			with the score file (default 10 seconds).
  */
 
 #include <signal.h>
@@ -47,7 +57,7 @@
 #include <errno.h>
 #include <time.h>
 #include <curses.h>
-#include "extern.h"
+#include "rogue.h"
 
 #define NOOP(x) (x += 0)
 
@@ -56,8 +66,25 @@
 #	define	NUMNAME		"Ten"
 # endif
 
+# ifndef MAXSCORES
+#	define	MAXSCORES	50000
+# endif
+
+# if defined(SCOREFILE) && !defined(XLOGFILE)
+#	define	XLOGFILE	"rogue.xlog"
+# endif
+
+# if defined(XLOGFILE) && !defined(XLOGBIN)
+#	define	XLOGBIN		XLOGFILE ".bin"
+# endif
+
+# ifndef LOCKTIME
+#	define	LOCKTIME	10
+# endif
+
 unsigned int numscores = NUMSCORES;
 char *Numname = NUMNAME;
+unsigned int maxscores = MAXSCORES;
 
 # ifdef ALLSCORES
 bool allscore = TRUE;
@@ -128,6 +155,52 @@ open_score()
 #endif
 }
 
+/*
+ * open_log:
+ *	Open up the game logs, which are only ever added to
+ */
+
+#ifdef XLOGFILE
+/*
+ * log_name:
+ *	Where a log goes: a bare name goes next to the score file, so
+ *	the logs don't end up wherever the game happened to be started
+ */
+static char *
+log_name(char *buf, char *name)
+{
+#ifdef SCOREFILE
+    char *dir = SCOREFILE, *sp;
+    size_t len;
+
+    if (strchr(name, '/') == NULL && (sp = strrchr(dir, '/')) != NULL)
+    {
+	len = sp - dir + 1;
+	if (len + strlen(name) < MAXSTR)
+	{
+	    memcpy(buf, dir, len);
+	    strcpy(buf + len, name);
+	    return buf;
+	}
+    }
+#endif
+    return name;
+}
+#endif
+
+void
+open_log()
+{
+#ifdef XLOGFILE
+    char buf[MAXSTR];
+
+    if (xlog < 0)
+	xlog = md_openappend(log_name(buf, XLOGFILE));
+    if (xlogbin < 0)
+	xlogbin = md_openappend(log_name(buf, XLOGBIN));
+#endif
+}
+
 /*
  * setup:
  *	Get starting setup for all games
@@ -366,64 +439,18 @@ ucount()
 
 /*
  * lock_sc:
- *	lock the score file.  If it takes too long, ask the user if
- *	they care to wait.  Return TRUE if the lock is successful.
+ *	lock the score file.  If someone else has it, wait up to
+ *	LOCKTIME seconds for them.  Return TRUE if the lock is
+ *	successful.
  */
-static FILE *lfd = NULL;
 bool
 lock_sc()
 {
-#if defined(SCOREFILE) && defined(LOCKFILE)
-    int cnt;
-    static struct stat sbuf;
-    char *lockfile = LOCKFILE;
-
-over:
-    if ((lfd=fopen(lockfile, "w+")) != NULL)
-	return TRUE;
-    for (cnt = 0; cnt < 5; cnt++)
-    {
-	md_sleep(1);
-	if ((lfd=fopen(lockfile, "w+")) != NULL)
-	    return TRUE;
-    }
-    if (stat(lockfile, &sbuf) < 0)
-    {
-	lfd=fopen(lockfile, "w+");
-	return TRUE;
-    }
-    if (time(NULL) - sbuf.st_mtime > 10)
-    {
-	if (md_unlink(lockfile) < 0)
-	    return FALSE;
-	goto over;
-    }
-    else
-    {
-	printf("The score file is very busy.  Do you want to wait longer\n");
-	printf("for it to become free so your score can get posted?\n");
-	printf("If so, type \"y\"\n");
-	(void) fgets(prbuf, MAXSTR, stdin);
-	if (prbuf[0] == 'y')
-	    for (;;)
-	    {
-		if ((lfd=fopen(lockfile, "w+")) != 0)
-		    return TRUE;
-		if (stat(lockfile, &sbuf) < 0)
-		{
-		    lfd=fopen(lockfile, "w+");
-		    return TRUE;
-		}
-		if (time(NULL) - sbuf.st_mtime > 10)
-		{
-		    if (md_unlink(lockfile) < 0)
-			return FALSE;
-		}
-		md_sleep(1);
-	    }
-	else
-	    return FALSE;
-    }
+#ifdef SCOREFILE
+    if (scoreboard == NULL)
+	return FALSE;
+    fflush(scoreboard);
+    return (md_lockfile(fileno(scoreboard), LOCKTIME) == 0);
 #else
     return TRUE;
 #endif
@@ -437,11 +464,12 @@ over:
 void
 unlock_sc()
 {
-#if defined(SCOREFILE) && defined(LOCKFILE)
-    if (lfd != NULL)
-        fclose(lfd);
-    lfd = NULL;
-    md_unlink(LOCKFILE);
+#ifdef SCOREFILE
+    if (scoreboard != NULL)
+    {
+	fflush(scoreboard);
+	md_unlockfile(fileno(scoreboard));
+    }
 #endif
 }
 
@@ -15,6 +15,7 @@
 #include <curses.h>
 #include "rogue.h"
 
+#ifndef ROGUE_SIM
 /*
  * main:
  *	The main program, of course
@@ -27,6 +28,12 @@ main(int argc, char **argv, char **envp)
 
     md_init();
 
+    if ((game = new_game()) == NULL)
+    {
+	printf("Can't allocate a game\n");
+	exit(1);
+    }
+
 #ifdef MASTER
     /*
      * Check to see if he is a wizard
@@ -62,9 +69,10 @@ main(int argc, char **argv, char **envp)
     else
 #endif
 	dnum = lowtime + md_getpid();
-    seed = dnum;
+    rng_seed(&game->g_rng, dnum);
 
     open_score();
+    open_log();
 
 	/* 
      * Drop setuid/setgid after opening the scoreboard file. 
@@ -113,12 +121,6 @@ main(int argc, char **argv, char **envp)
     fflush(stdout);
 
     initscr();				/* Start up cursor package */
-    init_probs();			/* Set up prob tables for objects */
-    init_player();			/* Set up initial player stats */
-    init_names();			/* Set up names of scrolls */
-    init_colors();			/* Set up colors of potions */
-    init_stones();			/* Set up stone settings of rings */
-    init_materials();			/* Set up materials of wands */
     setup();
 
     /*
@@ -140,6 +142,29 @@ main(int argc, char **argv, char **envp)
 #ifdef MASTER
     noscore = wizard;
 #endif
+    start_game();
+    replay_start();
+    playit();
+    return(0);
+}
+#endif /* ROGUE_SIM */
+
+/*
+ * start_game:
+ *	Roll up the object tables and the player, draw the first level
+ *	and get the daemons going.  Everything here is driven by seed,
+ *	so the same seed always gives the same game.
+ */
+
+void
+start_game()
+{
+    init_probs();			/* Set up prob tables for objects */
+    init_player();			/* Set up initial player stats */
+    init_names();			/* Set up names of scrolls */
+    init_colors();			/* Set up colors of potions */
+    init_stones();			/* Set up stone settings of rings */
+    init_materials();			/* Set up materials of wands */
     new_level();			/* Draw current level */
     /*
      * Start up daemons and fuses
@@ -148,8 +173,6 @@ main(int argc, char **argv, char **envp)
     start_daemon(doctor, 0, AFTER);
     fuse(swander, 0, WANDERTIME, AFTER);
     start_daemon(stomach, 0, AFTER);
-    playit();
-    return(0);
 }
 
 /*
@@ -178,16 +201,6 @@ fatal(char *s)
     my_exit(0);
 }
 
-/*
- * rnd:
- *	Pick a very random number.
- */
-int
-rnd(int range)
-{
-    return range == 0 ? 0 : abs((int) RN) % range;
-}
-
 /*
  * roll:
  *	Roll a number of dice
@@ -291,7 +304,8 @@ quit(int sig)
 {
     int oy, ox;
 
-    NOOP(sig);
+    if (sig != 0)
+	replay_intr();
 
     /*
      * Reset the signal in case we got here via an interrupt
@@ -303,6 +317,7 @@ quit(int sig)
     if (readchar() == 'y')
     {
 	signal(SIGINT, leave);
+	end_checkpoint();
 	clear();
 	mvprintw(LINES - 2, 0, "You quit with %d gold pieces", purse);
 	move(LINES - 1, 0);
@@ -367,9 +382,10 @@ shell()
     after = FALSE;
     fflush(stdout);
     /*
-     * Fork and do a shell
+     * Fork and do a shell, unless this is only a replay
      */
-    md_shellescape();
+    if (!replaying)
+	md_shellescape();
 
     printf("\n[Press return to continue]");
     fflush(stdout);
@@ -390,7 +406,14 @@ shell()
 void
 my_exit(int st)
 {
+#ifdef ROGUE_SIM
+    NOOP(st);
+    sim_end(SIM_EXIT);
+#else
+    rec_close();
+    replay_close();
     resetltchars();
     exit(st);
+#endif
 }
 
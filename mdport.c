@@ -93,11 +93,22 @@
 #include <sys/wait.h>
 #endif
 
+#if !defined(_WIN32)
+#include <sys/time.h>
+#include <sys/mman.h>
+#endif
+
+#if defined(HAVE_SYS_IOCTL_H)
+#include <sys/ioctl.h>
+#endif
+
 #include <ctype.h>
+#include <errno.h>
 #include <fcntl.h>
 #include <limits.h>
 #include <sys/stat.h>
 #include <signal.h>
+#include <time.h>
 #include "extern.h"
 
 #if !defined(PATH_MAX) && defined(_MAX_PATH)
@@ -265,7 +276,7 @@ md_hasclreol()
 	return(0);
 #endif
     return((clr_eol != NULL) && (*clr_eol != 0));
-#elif defined(__PDCURSES__)
+#elif defined(__PDCURSES__) || defined(ROGUE_SIM)
     return(TRUE);
 #else
     return((CE != NULL) && (*CE != 0));
@@ -351,6 +362,202 @@ md_unlink(char *file)
 #endif
 }
 
+int
+md_rename(char *from, char *to)
+{
+#ifdef _WIN32
+    _chmod(to, 0600);
+    return( MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING) ? 0 : -1 );
+#else
+    return( rename(from, to) );
+#endif
+}
+
+/*
+ * Start a child to do something in the background.  Like fork(), but
+ * returns -1 where there is no such thing.
+ */
+int
+md_fork()
+{
+#if defined(HAVE_WORKING_FORK)
+    return( fork() );
+#else
+    return(-1);
+#endif
+}
+
+/*
+ * Has a child from md_fork() finished?  If wait is set, wait for it.
+ */
+int
+md_child_done(int pid, int wait)
+{
+#if defined(HAVE_WORKING_FORK)
+    int status;
+
+    return( waitpid(pid, &status, wait ? 0 : WNOHANG) != 0 );
+#else
+    return(1);
+#endif
+}
+
+void
+md_child_exit(int status)
+{
+    _exit(status);
+}
+
+/*
+ * Take the kernel's advisory lock on a whole open file, waiting up to
+ * timeout seconds for whoever has it now.  Returns -1 if it didn't
+ * come free in time.  A lock goes away by itself when its process
+ * does, so there's never a stale one to clear up.
+ */
+int
+md_lockfile(int fd, int timeout)
+{
+#ifdef _WIN32
+    HANDLE h = (HANDLE) _get_osfhandle(fd);
+    OVERLAPPED ov;
+    long start = md_millis();
+
+    memset(&ov, 0, sizeof ov);
+    while (!LockFileEx(h, LOCKFILE_EXCLUSIVE_LOCK | LOCKFILE_FAIL_IMMEDIATELY,
+      0, MAXDWORD, MAXDWORD, &ov))
+    {
+	if (md_millis() - start >= timeout * 1000L)
+	    return(-1);
+	Sleep(50);
+    }
+    return(0);
+#else
+    struct flock fl;
+    struct timespec ts;
+    long start = md_millis();
+
+    memset(&fl, 0, sizeof fl);
+    fl.l_type = F_WRLCK;
+    fl.l_whence = SEEK_SET;
+    while (fcntl(fd, F_SETLK, &fl) < 0)
+    {
+	if ((errno != EACCES && errno != EAGAIN && errno != EINTR)
+	  || md_millis() - start >= timeout * 1000L)
+	    return(-1);
+	ts.tv_sec = 0;
+	ts.tv_nsec = 50 * 1000000L;
+	nanosleep(&ts, NULL);
+    }
+    return(0);
+#endif
+}
+
+void
+md_unlockfile(int fd)
+{
+#ifdef _WIN32
+    OVERLAPPED ov;
+
+    memset(&ov, 0, sizeof ov);
+    UnlockFileEx((HANDLE) _get_osfhandle(fd), 0, MAXDWORD, MAXDWORD, &ov);
+#else
+    struct flock fl;
+
+    memset(&fl, 0, sizeof fl);
+    fl.l_type = F_UNLCK;
+    fl.l_whence = SEEK_SET;
+    fcntl(fd, F_SETLK, &fl);
+#endif
+}
+
+/*
+ * Cut an open file down to size bytes
+ */
+int
+md_truncate(int fd, long size)
+{
+#ifdef _WIN32
+    return(_chsize(fd, size));
+#else
+    return(ftruncate(fd, (off_t) size));
+#endif
+}
+
+/*
+ * A pipe to a child from md_fork().  Writing to it never blocks: when
+ * it is full, md_write() just takes less or nothing.
+ */
+int
+md_pipe(int fds[2])
+{
+#if defined(HAVE_WORKING_FORK)
+    if (pipe(fds) != 0)
+	return(-1);
+    signal(SIGPIPE, SIG_IGN);
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+#if defined(F_SETPIPE_SZ)
+    fcntl(fds[1], F_SETPIPE_SZ, 256 * 1024);
+#endif
+    return(0);
+#else
+    return(-1);
+#endif
+}
+
+/*
+ * Make writing to a pipe from md_pipe() wait until it all goes, for
+ * the last of it before the pipe is closed.
+ */
+int
+md_pipe_wait(int fd)
+{
+#if defined(HAVE_WORKING_FORK)
+    return( fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK) );
+#else
+    return(-1);
+#endif
+}
+
+int
+md_read(int fd, void *buf, size_t size)
+{
+    return( (int) read(fd, buf, size) );
+}
+
+int
+md_write(int fd, void *buf, size_t size)
+{
+    int n;
+
+    if ((n = (int) write(fd, buf, size)) < 0 && errno == EAGAIN)
+	return(0);
+    return(n);
+}
+
+int
+md_close(int fd)
+{
+    return( close(fd) );
+}
+
+/*
+ * Open a file to add to the end of, making it if need be.  Each
+ * write lands at the end as a whole, even with other processes
+ * adding to it at the same time.
+ */
+int
+md_openappend(char *file)
+{
+#ifdef _WIN32
+    return( _open(file, _O_WRONLY | _O_APPEND | _O_CREAT | _O_BINARY,
+	_S_IREAD | _S_IWRITE) );
+#else
+    return( open(file, O_WRONLY | O_APPEND | O_CREAT, 0664) );
+#endif
+}
+
 int
 md_chmod(char *filename, int mode)
 {
@@ -516,6 +723,91 @@ md_sleep(int s)
 #endif
 }
 
+/*
+ * A clock in milliseconds, for timing things on the screen.  Only the
+ * difference between two readings means anything.
+ */
+long
+md_millis()
+{
+#ifdef _WIN32
+    return( (long) GetTickCount() );
+#else
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return( (long) tv.tv_sec * 1000 + tv.tv_usec / 1000 );
+#endif
+}
+
+/*
+ * The time of day, to the microsecond where we can tell
+ */
+void
+md_now(long *secp, long *usecp)
+{
+#ifdef _WIN32
+    *secp = (long) time(NULL);
+    *usecp = (long) (GetTickCount() % 1000) * 1000;
+#else
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    *secp = (long) tv.tv_sec;
+    *usecp = (long) tv.tv_usec;
+#endif
+}
+
+/*
+ * How many bytes we have written to the terminal that it hasn't taken
+ * yet, or -1 if there's no telling
+ */
+int
+md_outqueue()
+{
+#if defined(TIOCOUTQ)
+    int n;
+
+    if (ioctl(1, TIOCOUTQ, &n) == 0)
+	return(n);
+#endif
+    return(-1);
+}
+
+/*
+ * Map a file of the given size so that other processes mapping it
+ * see what we put in it, or return NULL if we can't
+ */
+void *
+md_mapfile(char *file, size_t size)
+{
+#ifdef _WIN32
+    return(NULL);
+#else
+    void *addr;
+    int fd;
+
+    if ((fd = open(file, O_RDWR | O_CREAT, 0644)) < 0)
+	return(NULL);
+    if (ftruncate(fd, (off_t) size) != 0)
+    {
+	close(fd);
+	return(NULL);
+    }
+    addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    return(addr == MAP_FAILED ? NULL : addr);
+#endif
+}
+
+void
+md_unmapfile(void *addr, size_t size)
+{
+#ifndef _WIN32
+    munmap(addr, size);
+#endif
+}
+
 char *
 md_getshell()
 {
@@ -1071,6 +1363,7 @@ md_setsuspchar(int c)
     ESC Ou,	ESC Ou,		ESC Ou,	    O		    /# Keypad 5	    #/
 */
 
+#ifndef ROGUE_SIM
 #define M_NORMAL 0
 #define M_ESC    1
 #define M_KEYPAD 2
@@ -1315,6 +1608,7 @@ md_readchar()
 
     return(ch & 0x7F);
 }
+#endif /* ROGUE_SIM */
 
 #if defined(LOADAV) && defined(HAVE_NLIST_H) && defined(HAVE_NLIST)
 /*
@@ -16,6 +16,8 @@
 #include <ctype.h>
 #include "rogue.h"
 
+#define last_delt	(game->g_last_delt)
+
 /*
  * look:
  *	A quick glance all around the player
@@ -29,7 +31,7 @@ look(bool wakeup)
     int x, y;
     int ch;
     THING *tp;
-    PLACE *pp;
+    int pp;
     struct room *rp;
     int ey, ex;
     int passcount;
@@ -60,8 +62,8 @@ look(bool wakeup)
 	diffhero = hero.y - hero.x;
     }
     pp = INDEX(hero.y, hero.x);
-    pch = pp->p_ch;
-    pfl = pp->p_flags;
+    pch = places.p_ch[pp];
+    pfl = places.p_flags[pp];
 
     for (y = sy; y <= ey; y++)
 	if (y > 0 && y < NUMLINES - 1) for (x = sx; x <= ex; x++)
@@ -75,10 +77,10 @@ look(bool wakeup)
 	    }
 
 	    pp = INDEX(y, x);
-	    ch = pp->p_ch;
+	    ch = places.p_ch[pp];
 	    if (ch == ' ')		/* nothing need be done with a ' ' */
 		    continue;
-	    fp = &pp->p_flags;
+	    fp = &places.p_flags[pp];
 	    if (pch != DOOR && ch != DOOR)
 		if ((pfl & F_PASS) != (*fp & F_PASS))
 		    continue;
@@ -90,7 +92,7 @@ look(bool wakeup)
 			continue;
 	    }
 
-	    if ((tp = pp->p_monst) == NULL)
+	    if ((tp = mslot[places.p_mon[pp]]) == NULL)
 		ch = trip_ch(y, x, ch);
 	    else
 		if (on(player, SEEMONST) && on(*tp, ISINVIS))
@@ -464,7 +466,6 @@ get_dir()
 {
     char *prompt;
     bool gotit;
-    static coord last_delt= {0,0};
 
     if (again && last_dir != '\0')
     {
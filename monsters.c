@@ -10,6 +10,7 @@
  * See the file LICENSE.TXT for full copyright and licensing information.
  */
 
+#include <stdlib.h>
 #include <curses.h>
 #include <string.h>
 #include "rogue.h"
@@ -64,19 +65,22 @@ new_monster(THING *tp, char type, coord *cp)
 
     if ((lev_add = level - AMULETLEVEL) < 0)
 	lev_add = 0;
-    attach(mlist, tp);
+    if (tp->t_slot == 0)
+	new_slot(tp);
     tp->t_type = type;
     tp->t_disguise = type;
     tp->t_pos = *cp;
+    attach(mlist, tp);
     move(cp->y, cp->x);
     tp->t_oldch = CCHAR( inch() );
     tp->t_room = roomin(cp);
-    moat(cp->y, cp->x) = tp;
+    set_moat(cp->y, cp->x, tp);
     mp = &monsters[tp->t_type-'A'];
     tp->t_stats.s_lvl = mp->m_stats.s_lvl + lev_add;
     tp->t_stats.s_maxhp = tp->t_stats.s_hpt = roll(tp->t_stats.s_lvl, 8);
     tp->t_stats.s_arm = mp->m_stats.s_arm - lev_add;
     strcpy(tp->t_stats.s_dmg,mp->m_stats.s_dmg);
+    tp->t_stats.s_dice = mp->m_stats.s_dice;
     tp->t_stats.s_str = mp->m_stats.s_str;
     tp->t_stats.s_exp = mp->m_stats.s_exp + lev_add * 10 + exp_add(tp);
     tp->t_flags = mp->m_flags;
@@ -90,6 +94,41 @@ new_monster(THING *tp, char type, coord *cp)
 	tp->t_disguise = rnd_thing();
 }
 
+/*
+ * new_slot:
+ *	Give a monster a slot number, which is what the map keeps
+ */
+void
+new_slot(THING *tp)
+{
+    int i;
+
+    for (i = 1; i < game->g_nmslot; i++)
+	if (mslot[i] == NULL)
+	    break;
+    if (i == game->g_nmslot)
+    {
+	if (i * 2 > 0xffff + 1
+	  || (mslot = realloc(mslot, i * 2 * sizeof *mslot)) == NULL)
+	    fatal("too many monsters\n");
+	memset(&mslot[i], 0, i * sizeof *mslot);
+	game->g_nmslot = i * 2;
+    }
+    mslot[i] = tp;
+    tp->t_slot = i;
+}
+
+/*
+ * free_slot:
+ *	A monster is leaving the level, so give its slot back
+ */
+void
+free_slot(THING *tp)
+{
+    mslot[tp->t_slot] = NULL;
+    tp->t_slot = 0;
+}
+
 /*
  * expadd:
  *	Experience to add for this monster's level/hit points
@@ -119,7 +158,7 @@ void
 wanderer()
 {
     THING *tp;
-    static coord cp;
+    static TLOCAL coord cp;
 
     tp = new_item();
     do
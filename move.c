@@ -14,12 +14,6 @@
 #include <ctype.h>
 #include "rogue.h"
 
-/*
- * used to hold the new hero position
- */
-
-coord nh;
-
 /*
  * do_run:
  *	Start the hero running
@@ -92,7 +86,7 @@ over:
     {
 	if (!on(player, ISLEVIT))
 	{
-	    chat(nh.y, nh.x) = ch = TRAP;
+	    set_chat(nh.y, nh.x, ch = TRAP);
 	    flat(nh.y, nh.x) |= F_REAL;
 	}
     }
@@ -207,11 +201,11 @@ move_stuff:
 bool
 turn_ok(int y, int x)
 {
-    PLACE *pp;
+    int pp;
 
     pp = INDEX(y, x);
-    return (pp->p_ch == DOOR
-	|| (pp->p_flags & (F_REAL|F_PASS)) == (F_REAL|F_PASS));
+    return (places.p_ch[pp] == DOOR
+	|| (places.p_flags[pp] & (F_REAL|F_PASS)) == (F_REAL|F_PASS));
 }
 
 /*
@@ -222,10 +216,10 @@ turn_ok(int y, int x)
 void
 turnref()
 {
-    PLACE *pp;
+    int pp;
 
     pp = INDEX(hero.y, hero.x);
-    if (!(pp->p_flags & F_SEEN))
+    if (!(places.p_flags[pp] & F_SEEN))
     {
 	if (jump)
 	{
@@ -233,7 +227,7 @@ turnref()
 	    refresh();
 	    leaveok(stdscr, FALSE);
 	}
-	pp->p_flags |= F_SEEN;
+	places.p_flags[pp] |= F_SEEN;
     }
 }
 
@@ -262,7 +256,7 @@ door_open(struct room *rp)
 char
 be_trapped(coord *tc)
 {
-    PLACE *pp;
+    int pp;
     THING *arrow;
     char tr;
 
@@ -271,9 +265,9 @@ be_trapped(coord *tc)
     running = FALSE;
     count = FALSE;
     pp = INDEX(tc->y, tc->x);
-    pp->p_ch = TRAP;
-    tr = pp->p_flags & F_TMASK;
-    pp->p_flags |= F_SEEN;
+    set_chat(tc->y, tc->x, TRAP);
+    tr = places.p_flags[pp] & F_TMASK;
+    places.p_flags[pp] |= F_SEEN;
     switch (tr)
     {
 	case T_DOOR:
@@ -363,7 +357,7 @@ rndmove(THING *who)
     THING *obj;
     int x, y;
     char ch;
-    static coord ret;  /* what we will be returning */
+    static TLOCAL coord ret;  /* what we will be returning */
 
     y = ret.y = who->t_pos.y + rnd(3) - 1;
     x = ret.x = who->t_pos.x + rnd(3) - 1;
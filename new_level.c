@@ -23,7 +23,6 @@ void
 new_level()
 {
     THING *tp;
-    PLACE *pp;
     char *sp;
     int i;
 
@@ -33,23 +32,18 @@ new_level()
     /*
      * Clean things off from last level
      */
-    for (pp = places; pp < &places[MAXCOLS*MAXLINES]; pp++)
-    {
-	pp->p_ch = ' ';
-	pp->p_flags = F_REAL;
-	pp->p_monst = NULL;
-    }
+    memset(places.p_ch, ' ', sizeof places.p_ch);
+    memset(places.p_flags, F_REAL, sizeof places.p_flags);
+    memset(places.p_mon, 0, sizeof places.p_mon);
+    memset(places.p_room, 0, sizeof places.p_room);
+    game->g_flow_ok = FALSE;
     clear();
     /*
-     * Free up the monsters on the last level
-     */
-    for (tp = mlist; tp != NULL; tp = next(tp))
-	free_list(tp->t_pack);
-    free_list(mlist);
-    /*
-     * Throw away stuff left on the previous level (if anything)
+     * Throw away the monsters and stuff left on the previous level
+     * (if anything)
      */
-    free_list(lvl_obj);
+    drop_level();
+    memset(mslot, 0, game->g_nmslot * sizeof *mslot);
     do_rooms();				/* Draw rooms */
     do_passages();			/* Draw passages */
     no_food++;
@@ -97,6 +91,7 @@ new_level()
 	turn_see(FALSE);
     if (on(player, ISHALU))
 	visuals();
+    hash_reset();
 }
 
 /*
@@ -166,6 +161,8 @@ put_things()
 	obj->o_dplus = 0;
 	strncpy(obj->o_damage,"0x0",sizeof(obj->o_damage));
         strncpy(obj->o_hurldmg,"0x0",sizeof(obj->o_hurldmg));
+	set_dice(&obj->o_dice, obj->o_damage);
+	set_dice(&obj->o_hurldice, obj->o_hurldmg);
 	obj->o_arm = 11;
 	obj->o_type = AMULET;
 	/*
@@ -190,7 +187,7 @@ treas_room()
     THING *tp;
     struct room *rp;
     int spots, num_monst;
-    static coord mp;
+    static TLOCAL coord mp;
 
     rp = &rooms[rnd_room()];
     spots = (rp->r_max.y - 2) * (rp->r_max.x - 2) - MINTREAS;
@@ -13,6 +13,7 @@
  */
 
 #include <stdlib.h>
+#include <stddef.h>
 #include <curses.h>
 #include <ctype.h>
 #include <string.h>
@@ -28,7 +29,7 @@
 struct optstruct {
     char	*o_name;	/* option name */
     char	*o_prompt;	/* prompt for interactive entry */
-    void 	*o_opt;		/* pointer to thing to set */
+    size_t	o_off;		/* where the thing to set is in the game */
 				/* function to print value */
     void 	(*o_putfunc)(void *opt);
 				/* function to get value interactively */
@@ -37,29 +38,46 @@ struct optstruct {
 
 typedef struct optstruct	OPTION;
 
+#define	G_OFF(f)	offsetof(struct game, f)
+#define	o_opt(op)	((void *) ((char *) game + (op)->o_off))
+
 void	pr_optname(OPTION *op);
 
 OPTION	optlist[] = {
     {"terse",	 "Terse output",
-		 &terse,	put_bool,	get_bool	},
+		 G_OFF(g_terse),	put_bool,	get_bool	},
     {"flush",	 "Flush typeahead during battle",
-		 &fight_flush,	put_bool,	get_bool	},
+		 G_OFF(g_fight_flush),	put_bool,	get_bool	},
     {"jump",	 "Show position only at end of run",
-		 &jump,		put_bool,	get_bool	},
+		 G_OFF(g_jump),		put_bool,	get_bool	},
     {"seefloor", "Show the lamp-illuminated floor",
-		 &see_floor,	put_bool,	get_sf		},
+		 G_OFF(g_see_floor),	put_bool,	get_sf		},
     {"passgo",	"Follow turnings in passageways",
-		 &passgo,	put_bool,	get_bool	},
+		 G_OFF(g_passgo),	put_bool,	get_bool	},
     {"tombstone", "Print out tombstone when killed",
-		 &tombstone,	put_bool,	get_bool	},
+		 G_OFF(g_tombstone),	put_bool,	get_bool	},
+    {"flowchase", "Monsters take the shortest path to you",
+		 G_OFF(g_flowchase),	put_bool,	get_bool	},
+    {"checkpoint", "Turns between checkpoints (0 for none)",
+		 G_OFF(g_ckpt_every),	put_int,	get_int		},
+    {"frametime", "Milliseconds of animation a turn (0 for all)",
+		 G_OFF(g_frame_time),	put_int,	get_int		},
     {"inven",	"Inventory style",
-		 &inv_type,	put_inv_t,	get_inv_t	},
+		 G_OFF(g_inv_type),	put_inv_t,	get_inv_t	},
     {"name",	 "Name",
-		 whoami,	put_str,	get_str		},
+		 G_OFF(g_whoami),	put_str,	get_str		},
     {"fruit",	 "Fruit",
-		 fruit,		put_str,	get_str		},
+		 G_OFF(g_fruit),		put_str,	get_str		},
     {"file",	 "Save file",
-		 file_name,	put_str,	get_str		}
+		 G_OFF(g_file_name),	put_str,	get_str		},
+    {"watch",	 "Watch file",
+		 G_OFF(g_watch_name),	put_str,	get_str		},
+    {"record",	 "Recording file",
+		 G_OFF(g_rec_name),	put_str,	get_str		},
+    {"recordsize", "Kilobytes to a recording file (0 for no limit)",
+		 G_OFF(g_rec_limit),	put_int,	get_int		},
+    {"replay",	 "Keystroke file",
+		 G_OFF(g_replay_name),	put_str,	get_str		}
 };
 
 /*
@@ -80,7 +98,7 @@ option()
     for (op = optlist; op <= &optlist[NUM_OPTS-1]; op++)
     {
 	pr_optname(op);
-	(*op->o_putfunc)(op->o_opt);
+	(*op->o_putfunc)(o_opt(op));
 	waddch(hw, '\n');
     }
     /*
@@ -90,7 +108,7 @@ option()
     for (op = optlist; op <= &optlist[NUM_OPTS-1]; op++)
     {
 	pr_optname(op);
-	retval = (*op->o_getfunc)(op->o_opt, hw);
+	retval = (*op->o_getfunc)(o_opt(op), hw);
 	if (retval)
 	{
 	    if (retval == QUIT)
@@ -152,6 +170,17 @@ put_str(void *str)
     waddstr(hw, (char *) str);
 }
 
+/*
+ * put_int:
+ *	Put out a number
+ */
+
+void
+put_int(void *ip)
+{
+    wprintw(hw, "%d", *(int *) ip);
+}
+
 /*
  * put_inv_t:
  *	Put out an inventory type
@@ -254,15 +283,15 @@ get_str(void *vopt, WINDOW *win)
     int oy, ox;
     int i;
     signed char c;
-    static char buf[MAXSTR];
+    static TLOCAL char buf[MAXSTR];
 
     getyx(win, oy, ox);
-    wrefresh(win);
+    sh_wrefresh(win);
     /*
      * loop reading in the string, and put it in a temporary buffer
      */
     for (sp = buf; (c = readchar()) != '\n' && c != '\r' && c != ESCAPE;
-	wclrtoeol(win), wrefresh(win))
+	wclrtoeol(win), sh_wrefresh(win))
     {
 	if (c == -1)
 	    continue;
@@ -306,7 +335,7 @@ get_str(void *vopt, WINDOW *win)
     if (sp > buf)	/* only change option if something has been typed */
 	strucpy(opt, buf, (int) strlen(buf));
     mvwprintw(win, oy, ox, "%s\n", opt);
-    wrefresh(win);
+    sh_wrefresh(win);
     if (win == stdscr)
 	mpos += (int)(sp - buf);
     if (c == '-')
@@ -317,6 +346,24 @@ get_str(void *vopt, WINDOW *win)
 	return NORM;
 }
 
+/*
+ * get_int:
+ *	Set a number option, which can't go below zero
+ */
+int
+get_int(void *vp, WINDOW *win)
+{
+    int *ip = (int *) vp;
+    int retval;
+    char buf[MAXSTR];
+
+    sprintf(buf, "%d", *ip);
+    retval = get_str(buf, win);
+    if ((*ip = atoi(buf)) < 0)
+	*ip = 0;
+    return retval;
+}
+
 /*
  * get_inv_t
  *	Get an inventory type name
@@ -380,7 +427,7 @@ get_num(void *vp, WINDOW *win)
 {
     short *opt = (short *) vp;
     int i;
-    static char buf[MAXSTR];
+    static TLOCAL char buf[MAXSTR];
 
     if ((i = get_str(buf, win)) == NORM)
 	*opt = (short) atoi(buf);
@@ -421,7 +468,7 @@ parse_opts(char *str)
 	    if (EQSTR(str, op->o_name, len))
 	    {
 		if (op->o_putfunc == put_bool)	/* if option is a boolean */
-		    *(bool *)op->o_opt = TRUE;	/* NOSTRICT */
+		    *(bool *)o_opt(op) = TRUE;	/* NOSTRICT */
 		else				/* string option */
 		{
 		    /*
@@ -431,13 +478,13 @@ parse_opts(char *str)
 			continue;
 		    if (*str == '~')
 		    {
-			strcpy((char *) op->o_opt, home);	  /* NOSTRICT */
-			start = (char *) op->o_opt + strlen(home);/* NOSTRICT */
+			strcpy((char *) o_opt(op), home);	  /* NOSTRICT */
+			start = (char *) o_opt(op) + strlen(home);/* NOSTRICT */
 			while (*++str == '/')
 			    continue;
 		    }
 		    else
-			start = (char *) op->o_opt;	/* NOSTRICT */
+			start = (char *) o_opt(op);	/* NOSTRICT */
 		    /*
 		     * Skip to end of string value
 		     */
@@ -457,6 +504,11 @@ parse_opts(char *str)
 				break;
 			    }
 		    }
+		    else if (op->o_putfunc == put_int)
+		    {
+			if ((*(int *) o_opt(op) = atoi(str)) < 0)
+			    *(int *) o_opt(op) = 0;
+		    }
 		    else
 			strucpy(start, str, (int)(sp - str));
 		}
@@ -468,7 +520,7 @@ parse_opts(char *str)
 	    else if (op->o_putfunc == put_bool
 	      && EQSTR(str, "no", 2) && EQSTR(str + 2, op->o_name, len - 2))
 	    {
-		*(bool *)op->o_opt = FALSE;	/* NOSTRICT */
+		*(bool *)o_opt(op) = FALSE;	/* NOSTRICT */
 		break;
 	    }
 
@@ -481,6 +533,41 @@ parse_opts(char *str)
     }
 }
 
+/*
+ * opt_string:
+ *	Put every option as it is set now into buf, the way
+ *	parse_opts() takes them.  Strings that are empty are left out,
+ *	since parse_opts() can't tell them from the next option.
+ */
+
+void
+opt_string(char *buf, size_t size)
+{
+    OPTION *op;
+    char *sp;
+    size_t len;
+
+    buf[0] = '\0';
+    for (op = optlist, len = 0; op <= &optlist[NUM_OPTS-1]; op++)
+    {
+	sp = &buf[len];
+	if (op->o_putfunc == put_bool)
+	    snprintf(sp, size - len, "%s%s,",
+		*(bool *) o_opt(op) ? "" : "no", op->o_name);
+	else if (op->o_putfunc == put_int)
+	    snprintf(sp, size - len, "%s=%d,", op->o_name, *(int *) o_opt(op));
+	else if (op->o_putfunc == put_inv_t)
+	    snprintf(sp, size - len, "%s=%s,", op->o_name,
+		inv_t_name[*(int *) o_opt(op)]);
+	else if (*(char *) o_opt(op) != '\0')
+	    snprintf(sp, size - len, "%s=%s,", op->o_name, (char *) o_opt(op));
+	if ((len += strlen(sp)) >= size - 1)
+	    break;
+    }
+    if (len > 0 && buf[len - 1] == ',')
+	buf[len - 1] = '\0';
+}
+
 /*
  * strucpy:
  *	Copy string using unctrl for things
@@ -44,7 +44,7 @@ add_pack(THING *obj, bool silent)
 	{
 	    detach(lvl_obj, obj);
 	    mvaddch(hero.y, hero.x, floor_ch());
-	    chat(hero.y, hero.x) = (proom->r_flags & ISGONE) ? PASSAGE : FLOOR;
+	    set_chat(hero.y, hero.x, (proom->r_flags & ISGONE) ? PASSAGE : FLOOR);
 	    discard(obj);
 	    msg("the scroll turns to dust as you pick it up");
 	    return;
@@ -52,9 +52,11 @@ add_pack(THING *obj, bool silent)
 
     if (pack == NULL)
     {
+	if (!pack_room(from_floor, obj))
+	    return;
 	pack = obj;
+	hash_attach(&pack, obj);
 	obj->o_packch = pack_char();
-	inpack++;
     }
     else
     {
@@ -130,6 +132,7 @@ out:
 		if (next(lp) != NULL)
 		    prev(next(lp)) = obj;
 		next(lp) = obj;
+		hash_attach(&pack, obj);
 	    }
 	}
     }
@@ -183,7 +186,7 @@ pack_room(bool from_floor, THING *obj)
     {
 	detach(lvl_obj, obj);
 	mvaddch(hero.y, hero.x, floor_ch());
-	chat(hero.y, hero.x) = (proom->r_flags & ISGONE) ? PASSAGE : FLOOR;
+	set_chat(hero.y, hero.x, (proom->r_flags & ISGONE) ? PASSAGE : FLOOR);
     }
 
     return TRUE;
@@ -247,7 +250,7 @@ pack_char()
 bool
 inventory(THING *list, int type)
 {
-    static char inv_temp[MAXSTR];
+    static TLOCAL char inv_temp[MAXSTR];
 
     n_objs = 0;
     for (; list != NULL; list = next(list))
@@ -452,7 +455,7 @@ money(int value)
 {
     purse += value;
     mvaddch(hero.y, hero.x, floor_ch());
-    chat(hero.y, hero.x) = (proom->r_flags & ISGONE) ? PASSAGE : FLOOR;
+    set_chat(hero.y, hero.x, (proom->r_flags & ISGONE) ? PASSAGE : FLOOR);
     if (value > 0)
     {
 	if (!terse)
@@ -25,7 +25,7 @@ do_passages()
     struct rdes *r1, *r2 = NULL;
     int i, j;
     int roomcount;
-    static struct rdes
+    static TLOCAL struct rdes
     {
 	bool	conn[MAXROOMS];		/* possible to connect to room i? */
 	bool	isconn[MAXROOMS];	/* connection been made to room i? */
@@ -137,7 +137,7 @@ conn(int r1, int r2)
     int distance = 0, turn_spot, turn_distance = 0;
     int rm;
     char direc;
-    static coord del, curr, turn_delta, spos, epos;
+    static TLOCAL coord del, curr, turn_delta, spos, epos;
 
     if (r1 < r2)
     {
@@ -273,14 +273,14 @@ conn(int r1, int r2)
 void
 putpass(coord *cp)
 {
-    PLACE *pp;
+    int pp;
 
     pp = INDEX(cp->y, cp->x);
-    pp->p_flags |= F_PASS;
+    places.p_flags[pp] |= F_PASS;
     if (rnd(10) + 1 < level && rnd(40) == 0)
-	pp->p_flags &= ~F_REAL;
+	places.p_flags[pp] &= ~F_REAL;
     else
-	pp->p_ch = PASSAGE;
+	places.p_ch[pp] = PASSAGE;
 }
 
 /*
@@ -292,7 +292,7 @@ putpass(coord *cp)
 void
 door(struct room *rm, coord *cp)
 {
-    PLACE *pp;
+    int pp;
 
     rm->r_exit[rm->r_nexits++] = *cp;
 
@@ -303,13 +303,13 @@ door(struct room *rm, coord *cp)
     if (rnd(10) + 1 < level && rnd(5) == 0)
     {
 	if (cp->y == rm->r_pos.y || cp->y == rm->r_pos.y + rm->r_max.y - 1)
-		pp->p_ch = '-';
+		places.p_ch[pp] = '-';
 	else
-		pp->p_ch = '|';
-	pp->p_flags &= ~F_REAL;
+		places.p_ch[pp] = '|';
+	places.p_flags[pp] &= ~F_REAL;
     }
     else
-	pp->p_ch = DOOR;
+	places.p_ch[pp] = DOOR;
 }
 
 #ifdef MASTER
@@ -321,7 +321,7 @@ door(struct room *rm, coord *cp)
 void
 add_pass()
 {
-    PLACE *pp;
+    int pp;
     int y, x;
     char ch;
 
@@ -329,22 +329,22 @@ add_pass()
 	for (x = 0; x < NUMCOLS; x++)
 	{
 	    pp = INDEX(y, x);
-	    if ((pp->p_flags & F_PASS) || pp->p_ch == DOOR ||
-		(!(pp->p_flags&F_REAL) && (pp->p_ch == '|' || pp->p_ch == '-')))
+	    if ((places.p_flags[pp] & F_PASS) || places.p_ch[pp] == DOOR ||
+		(!(places.p_flags[pp]&F_REAL) && (places.p_ch[pp] == '|' || places.p_ch[pp] == '-')))
 	    {
-		ch = pp->p_ch;
-		if (pp->p_flags & F_PASS)
+		ch = places.p_ch[pp];
+		if (places.p_flags[pp] & F_PASS)
 		    ch = PASSAGE;
-		pp->p_flags |= F_SEEN;
+		places.p_flags[pp] |= F_SEEN;
 		move(y, x);
-		if (pp->p_monst != NULL)
-		    pp->p_monst->t_oldch = pp->p_ch;
-		else if (pp->p_flags & F_REAL)
+		if (places.p_mon[pp] != 0)
+		    mslot[places.p_mon[pp]]->t_oldch = places.p_ch[pp];
+		else if (places.p_flags[pp] & F_REAL)
 		    addch(ch);
 		else
 		{
 		    standout();
-		    addch((pp->p_flags & F_PASS) ? PASSAGE : DOOR);
+		    addch((places.p_flags[pp] & F_PASS) ? PASSAGE : DOOR);
 		    standend();
 		}
 	    }
@@ -356,8 +356,8 @@ add_pass()
  * passnum:
  *	Assign a number to each passageway
  */
-static int pnum;
-static bool newpnum;
+static TLOCAL int pnum;
+static TLOCAL bool newpnum;
 
 
 void
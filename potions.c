@@ -33,8 +33,8 @@ static PACT p_actions[] =
 	{ 0,		NULL,	0 },			/* P_POISON */
 	{ 0,		NULL,	0 },			/* P_STRENGTH */
 	{ CANSEE,	unsee,	SEEDURATION,		/* P_SEEINVIS */
-		prbuf,
-		prbuf },
+		NULL,		/* NULL means the message is in prbuf */
+		NULL },
 	{ 0,		NULL,	0 },			/* P_HEALING */
 	{ 0,		NULL,	0 },			/* P_MFIND */
 	{ 0,		NULL,	0 },			/* P_TFIND  */
@@ -371,5 +371,8 @@ do_pot(int type, bool knowit)
     }
     else
 	lengthen(pp->pa_daemon, t);
-    msg(choose_str(pp->pa_high, pp->pa_straight));
+    if (pp->pa_high == NULL)
+	msg(prbuf);
+    else
+	msg(choose_str(pp->pa_high, pp->pa_straight));
 }
@@ -0,0 +1,378 @@
+/*
+ * Record the game as it is played, in ttyrec format: each frame is a
+ * header with the time and a length, followed by what it takes to
+ * draw it on an ANSI terminal.  The frames are made from the shadow
+ * screen and handed to a child process that does the writing, so a
+ * slow disk never holds up the game.
+ *
+ * Rogue: Exploring the Dungeons of Doom
+ * Copyright (C) 1980-1983, 1985, 1999 Michael Toy, Ken Arnold and Glenn Wichman
+ * All rights reserved.
+ *
+ * See the file LICENSE.TXT for full copyright and licensing information.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <curses.h>
+#include "rogue.h"
+
+#define REC_HEAD	12		/* Bytes in a frame header */
+#define REC_QUEUE	(64 * 1024)	/* Most we keep when the pipe is full */
+#define REC_ROTATE	0xffffffffU	/* Frame length meaning "new file" */
+
+#define rec_name	(game->g_rec_name)
+#define rec_limit	(game->g_rec_limit)
+#define rec_at		(game->g_rec_at)
+#define rec_on		(game->g_rec_on)
+#define rec_fd		(game->g_rec_fd)
+#define rec_file	(game->g_rec_file)
+#define rec_pid		(game->g_rec_pid)
+#define rec_bytes	(game->g_rec_bytes)
+#define rec_key		(game->g_rec_key)
+#define rec_out		(game->g_rec_out)
+#define rec_q		(game->g_rec_q)
+#define rec_qlen	(game->g_rec_qlen)
+
+/*
+ * rec_put32:
+ *	Put a number in a frame header, least significant byte first
+ */
+static void
+rec_put32(unsigned char *p, unsigned int v)
+{
+    p[0] = (unsigned char) (v & 0xff);
+    p[1] = (unsigned char) ((v >> 8) & 0xff);
+    p[2] = (unsigned char) ((v >> 16) & 0xff);
+    p[3] = (unsigned char) ((v >> 24) & 0xff);
+}
+
+static unsigned int
+rec_get32(unsigned char *p)
+{
+    return (unsigned int) p[0] | ((unsigned int) p[1] << 8)
+	| ((unsigned int) p[2] << 16) | ((unsigned int) p[3] << 24);
+}
+
+/*
+ * rec_rotate:
+ *	Move the recording out of the way, as name.1, name.2 and so on,
+ *	and start a new one
+ */
+static FILE *
+rec_rotate(FILE *outf, char *name)
+{
+    char buf[MAXSTR + 16];
+    FILE *fp;
+    int n;
+
+    fclose(outf);
+    for (n = 1; ; n++)
+    {
+	sprintf(buf, "%s.%d", name, n);
+	if ((fp = fopen(buf, "r")) == NULL)
+	    break;
+	fclose(fp);
+    }
+    md_rename(name, buf);
+    return fopen(name, "wb");
+}
+
+/*
+ * rec_writer:
+ *	The child that writes the recording, taking frames off the pipe
+ *	until the game closes it
+ */
+static void
+rec_writer(int fd, FILE *outf)
+{
+    unsigned char head[REC_HEAD], *buf;
+    unsigned int len;
+    int n, got;
+
+    md_ignoreallsignals();
+    if ((buf = malloc(REC_QUEUE)) == NULL)
+	md_child_exit(1);
+    for (;;)
+    {
+	for (got = 0; got < REC_HEAD; got += n)
+	    if ((n = md_read(fd, head + got, REC_HEAD - got)) <= 0)
+		goto done;
+	len = rec_get32(head + 8);
+	if (len == REC_ROTATE)
+	{
+	    if (outf != NULL)
+		outf = rec_rotate(outf, rec_at);
+	    continue;
+	}
+	if (outf != NULL)
+	    fwrite(head, REC_HEAD, 1, outf);
+	while (len > 0)
+	{
+	    if ((n = md_read(fd, buf, len < REC_QUEUE ? len : REC_QUEUE)) <= 0)
+		goto done;
+	    if (outf != NULL)
+		fwrite(buf, n, 1, outf);
+	    len -= n;
+	}
+    }
+done:
+    if (outf != NULL)
+	fclose(outf);
+    md_child_exit(0);
+}
+
+/*
+ * rec_open:
+ *	Start recording in rec_name, after whatever is there already
+ */
+static void
+rec_open()
+{
+    FILE *outf;
+    int fds[2];
+
+    strcpy(rec_at, rec_name);
+    if ((outf = fopen(rec_at, "ab")) == NULL)
+	return;
+    fseek(outf, 0L, SEEK_END);
+    rec_bytes = ftell(outf);
+    rec_key = TRUE;
+    rec_qlen = 0;
+    rec_on = TRUE;
+    if (md_pipe(fds) == 0)
+    {
+	fflush(stdout);
+	if ((rec_pid = md_fork()) == 0)
+	{
+	    md_close(fds[1]);
+	    rec_writer(fds[0], outf);
+	}
+	md_close(fds[0]);
+	if (rec_pid > 0)
+	{
+	    fclose(outf);
+	    rec_fd = fds[1];
+	    return;
+	}
+	md_close(fds[1]);
+    }
+    /*
+     * No child to do it, so write it ourselves
+     */
+    rec_pid = 0;
+    rec_file = outf;
+}
+
+/*
+ * rec_lost:
+ *	The writer has gone away, so stop recording
+ */
+static bool
+rec_lost()
+{
+    md_close(rec_fd);
+    rec_qlen = 0;
+    rec_on = FALSE;
+    return FALSE;
+}
+
+/*
+ * rec_send:
+ *	Hand a frame to the writer.  If the pipe won't take it all, the
+ *	rest waits its turn; if too much is waiting already, the frame
+ *	is left out and the next one draws the whole screen.
+ */
+static bool
+rec_send(unsigned char *buf, int len)
+{
+    int n;
+
+    if (rec_file != NULL)
+    {
+	fwrite(buf, len, 1, rec_file);
+	return TRUE;
+    }
+    if (len > REC_QUEUE
+      || (rec_q == NULL && (rec_q = malloc(REC_QUEUE)) == NULL))
+	return FALSE;
+    if (rec_qlen > 0)
+    {
+	if ((n = md_write(rec_fd, rec_q, rec_qlen)) < 0)
+	    return rec_lost();
+	memmove(rec_q, rec_q + n, rec_qlen - n);
+	rec_qlen -= n;
+	if (rec_qlen + len > REC_QUEUE)
+	    return FALSE;
+	memcpy(rec_q + rec_qlen, buf, len);
+	rec_qlen += len;
+	return TRUE;
+    }
+    if ((n = md_write(rec_fd, buf, len)) < 0)
+	return rec_lost();
+    memcpy(rec_q, buf + n, len - n);
+    rec_qlen = len - n;
+    return TRUE;
+}
+
+/*
+ * rec_cells:
+ *	Draw part of a line of the shadow
+ */
+static char *
+rec_cells(char *op, unsigned char *cp, int n, bool *sop)
+{
+    for (; n > 0; n--, cp++)
+    {
+	if ((*cp & 0x80) && !*sop)
+	{
+	    strcpy(op, "\033[7m");
+	    op += 4;
+	    *sop = TRUE;
+	}
+	else if (!(*cp & 0x80) && *sop)
+	{
+	    strcpy(op, "\033[m");
+	    op += 3;
+	    *sop = FALSE;
+	}
+	*op++ = (char) (*cp & 0x7f);
+    }
+    return op;
+}
+
+/*
+ * rec_frame:
+ *	Record what has changed on the screen since the last frame
+ */
+void
+rec_frame()
+{
+    unsigned char *sp, *cp;
+    char *op;
+    int lines, cols, y, x, x1, x2;
+    long sec, usec;
+    bool so;
+
+    if (replaying)
+	return;
+    if (strcmp(rec_name, rec_at) != 0)
+    {
+	rec_close();
+	if (rec_name[0] != '\0')
+	    rec_open();
+    }
+    if (!rec_on || (sp = sh_at(&lines, &cols)) == NULL)
+	return;
+    if (rec_limit > 0 && rec_bytes >= (long) rec_limit * 1024)
+    {
+	unsigned char mark[REC_HEAD];
+
+	memset(mark, 0, REC_HEAD);
+	rec_put32(mark + 8, REC_ROTATE);
+	if (rec_file != NULL)
+	{
+	    if ((rec_file = rec_rotate(rec_file, rec_at)) == NULL)
+	    {
+		rec_on = FALSE;
+		return;
+	    }
+	}
+	else if (!rec_send(mark, REC_HEAD))
+	    return;
+	rec_bytes = 0;
+	rec_key = TRUE;
+    }
+    if (rec_out == NULL
+      && (rec_out = malloc(REC_HEAD + lines * (cols * 5 + 16) + 32)) == NULL)
+	return;
+
+    op = rec_out + REC_HEAD;
+    so = FALSE;
+    if (rec_key)
+    {
+	strcpy(op, "\033[H\033[2J");
+	op += 7;
+    }
+    for (y = 0; y < lines; y++)
+    {
+	cp = &sp[y * cols];
+	if (rec_key)
+	{
+	    for (x2 = cols - 1; x2 >= 0 && cp[x2] == ' '; x2--)
+		continue;
+	    x1 = 0;
+	}
+	else if (!sh_dirty(y, &x1, &x2))
+	    continue;
+	if (x2 < x1)
+	    continue;
+	sprintf(op, "\033[%d;%dH", y + 1, x1 + 1);
+	op += strlen(op);
+	op = rec_cells(op, cp + x1, x2 - x1 + 1, &so);
+    }
+    if (so)
+    {
+	strcpy(op, "\033[m");
+	op += 3;
+    }
+    getyx(stdscr, y, x);
+    sprintf(op, "\033[%d;%dH", y + 1, x + 1);
+    op += strlen(op);
+
+    md_now(&sec, &usec);
+    rec_put32((unsigned char *) rec_out, (unsigned int) sec);
+    rec_put32((unsigned char *) rec_out + 4, (unsigned int) usec);
+    rec_put32((unsigned char *) rec_out + 8,
+	(unsigned int) (op - rec_out - REC_HEAD));
+    if (rec_send((unsigned char *) rec_out, (int) (op - rec_out)))
+    {
+	rec_bytes += (long) (op - rec_out);
+	rec_key = FALSE;
+    }
+    else
+	rec_key = TRUE;
+}
+
+/*
+ * rec_close:
+ *	Finish the recording.  Whatever is still waiting to go to the
+ *	writer goes now, even if that means waiting.
+ */
+void
+rec_close()
+{
+    int n;
+
+    if (rec_on)
+    {
+	if (rec_file != NULL)
+	    fclose(rec_file);
+	else
+	{
+	    md_pipe_wait(rec_fd);
+	    while (rec_qlen > 0 && (n = md_write(rec_fd, rec_q, rec_qlen)) > 0)
+	    {
+		memmove(rec_q, rec_q + n, rec_qlen - n);
+		rec_qlen -= n;
+	    }
+	    md_close(rec_fd);
+	}
+    }
+    /*
+     * With its end of the pipe closed, the writer finishes the file
+     * and goes; wait for it so it isn't left behind
+     */
+    if (rec_pid > 0)
+	md_child_done(rec_pid, TRUE);
+    rec_pid = 0;
+    free(rec_q);
+    free(rec_out);
+    rec_q = NULL;
+    rec_out = NULL;
+    rec_file = NULL;
+    rec_qlen = 0;
+    rec_on = FALSE;
+    rec_at[0] = '\0';
+}
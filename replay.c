@@ -0,0 +1,311 @@
+/*
+ * Record a game as the keystrokes that played it, so that it can be
+ * played over again, exactly, by rogue-sim --replay.  The file starts
+ * with what the game was set going from and then has what readchar()
+ * returned, a byte at a time.  Every RP_EVERY turns a checksum of the
+ * game (from hash_game()) goes in as well, so a replay that goes
+ * astray is caught on that turn instead of at the end.
+ *
+ *	header:	RP_MAGIC (4), RP_VERSION (2), random number engine (1),
+ *		0 (1), dungeon number (4), length of the options (2),
+ *		the options, as they would be given in ROGUEOPTS
+ *	then:	a keystroke (0-127), or
+ *		RP_SUM, turn (4), checksum (4), or
+ *		RP_INTR, when an interrupt made her quit()
+ *
+ * Numbers are least significant byte first.  The last thing in the
+ * file is a checksum of how the game ended.
+ *
+ * Rogue: Exploring the Dungeons of Doom
+ * Copyright (C) 1980-1983, 1985, 1999 Michael Toy, Ken Arnold and Glenn Wichman
+ * All rights reserved.
+ *
+ * See the file LICENSE.TXT for full copyright and licensing information.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <signal.h>
+#include <curses.h>
+#include "rogue.h"
+
+#define RP_MAGIC	0x50524752	/* "RGRP" */
+#define RP_VERSION	3
+#define RP_HEAD		14		/* Bytes in the header before the options */
+#define RP_SUM		0xff		/* A checksum follows */
+#define RP_INTR		0xfe		/* An interrupt came in */
+#define RP_EVERY	20		/* Turns between checksums */
+
+#define rp_file		(game->g_rp_file)
+#define rp_head		(game->g_rp_head)
+#define rp_due		(game->g_rp_due)
+#define rp_buf		(game->g_rp_buf)
+#define rp_len		(game->g_rp_len)
+#define rp_pos		(game->g_rp_pos)
+
+/*
+ * rp_put32:
+ *	Put a number in the file, least significant byte first
+ */
+static void
+rp_put32(unsigned char *p, unsigned int v)
+{
+    p[0] = (unsigned char) (v & 0xff);
+    p[1] = (unsigned char) ((v >> 8) & 0xff);
+    p[2] = (unsigned char) ((v >> 16) & 0xff);
+    p[3] = (unsigned char) ((v >> 24) & 0xff);
+}
+
+/*
+ * rp_sum:
+ *	Checksum the game, folding the state hash down to 32 bits
+ */
+static unsigned int
+rp_sum()
+{
+    hash_t h;
+
+    h = hash_game();
+    return (unsigned int) (h ^ (h >> 32));
+}
+
+/*
+ * rp_putsum:
+ *	Put a checksum of the game as it is now in the recording
+ */
+static void
+rp_putsum()
+{
+    unsigned char buf[9];
+
+    buf[0] = RP_SUM;
+    rp_put32(buf + 1, (unsigned int) turns);
+    rp_put32(buf + 5, rp_sum());
+    fwrite(buf, sizeof buf, 1, rp_file);
+}
+
+/*
+ * replay_start:
+ *	Get ready to record a new game, if she asked for it.  The
+ *	header waits for the first keystroke, so it gets the options
+ *	as they are once the game is set up.
+ */
+void
+replay_start()
+{
+    if (replay_name[0] == '\0' || rp_file != NULL)
+	return;
+    rp_file = fopen(replay_name, "wb");
+    rp_head = FALSE;
+    rp_due = 0;
+}
+
+/*
+ * rp_header:
+ *	Write what the game was started from
+ */
+static void
+rp_header()
+{
+    unsigned char head[RP_HEAD];
+    char opts[8 * MAXSTR];
+    size_t len;
+
+    opt_string(opts, sizeof opts);
+    len = strlen(opts);
+    rp_put32(head, RP_MAGIC);
+    head[4] = RP_VERSION & 0xff;
+    head[5] = RP_VERSION >> 8;
+    head[6] = (unsigned char) game->g_rng.r_engine;
+    head[7] = 0;
+    rp_put32(head + 8, (unsigned int) dnum);
+    head[12] = (unsigned char) (len & 0xff);
+    head[13] = (unsigned char) (len >> 8);
+    fwrite(head, RP_HEAD, 1, rp_file);
+    fwrite(opts, len, 1, rp_file);
+    rp_head = TRUE;
+}
+
+/*
+ * replay_key:
+ *	Record a keystroke.  It goes out right away, so the recording
+ *	is all there even if the game crashes.
+ */
+void
+replay_key(int ch)
+{
+    if (rp_file == NULL)
+	return;
+    if (!rp_head)
+	rp_header();
+    if (turns >= rp_due)
+    {
+	rp_putsum();
+	rp_due = turns + RP_EVERY;
+    }
+    putc(ch & 0x7f, rp_file);
+    fflush(rp_file);
+}
+
+/*
+ * replay_intr:
+ *	Record that an interrupt came in
+ */
+void
+replay_intr()
+{
+    if (rp_file == NULL)
+	return;
+    if (!rp_head)
+	rp_header();
+    putc(RP_INTR, rp_file);
+    fflush(rp_file);
+}
+
+/*
+ * replay_close:
+ *	Finish the recording with how the game ended
+ */
+void
+replay_close()
+{
+    if (rp_file != NULL)
+    {
+	if (rp_head)
+	    rp_putsum();
+	fclose(rp_file);
+    }
+    rp_file = NULL;
+    free(rp_buf);
+    rp_buf = NULL;
+}
+
+#ifdef ROGUE_SIM
+/*
+ * rp_get32:
+ *	Get a number back out of the file
+ */
+static unsigned int
+rp_get32(unsigned char *p)
+{
+    return (unsigned int) p[0] | ((unsigned int) p[1] << 8)
+	| ((unsigned int) p[2] << 16) | ((unsigned int) p[3] << 24);
+}
+
+/*
+ * replay_load:
+ *	Read in a recording and set the game up the way it was started,
+ *	leaving the dungeon number to play in *dnump.  Returns FALSE if
+ *	the file won't do.
+ */
+bool
+replay_load(char *file, int *dnump)
+{
+    FILE *fp;
+    long size;
+    size_t len;
+    char *opts;
+
+    if ((fp = fopen(file, "rb")) == NULL)
+	return FALSE;
+    fseek(fp, 0L, SEEK_END);
+    size = ftell(fp);
+    rewind(fp);
+    if (size < RP_HEAD || (rp_buf = malloc(size)) == NULL
+      || fread(rp_buf, 1, size, fp) != (size_t) size)
+    {
+	fclose(fp);
+	return FALSE;
+    }
+    fclose(fp);
+    rp_len = (size_t) size;
+    len = rp_buf[12] | (rp_buf[13] << 8);
+    if (rp_get32(rp_buf) != RP_MAGIC || rp_buf[4] != RP_VERSION
+      || rp_buf[6] >= NRNG || RP_HEAD + len > rp_len
+      || (opts = malloc(len + 1)) == NULL)
+	return FALSE;
+    memcpy(opts, rp_buf + RP_HEAD, len);
+    opts[len] = '\0';
+    parse_opts(opts);
+    free(opts);
+    rp_pos = RP_HEAD + len;
+    rp_due = 0;
+    game->g_rng.r_engine = rp_buf[6];
+    game->g_sim_wait = TRUE;
+    game->g_rp_sums = 0;
+    game->g_rp_keys = 0;
+    game->g_rp_astray = FALSE;
+    replaying = TRUE;
+    /*
+     * Nothing the replay does goes outside the game
+     */
+    ckpt_every = 0;
+    replay_name[0] = '\0';
+    game->g_watch_name[0] = '\0';
+    game->g_rec_name[0] = '\0';
+    *dnump = (int) rp_get32(rp_buf + 8);
+    return TRUE;
+}
+
+/*
+ * rp_check:
+ *	Take a checksum from the recording and see that the game still
+ *	matches it
+ */
+static bool
+rp_check()
+{
+    if (rp_pos + 9 > rp_len || rp_buf[rp_pos] != RP_SUM
+      || rp_get32(rp_buf + rp_pos + 1) != (unsigned int) turns
+      || rp_get32(rp_buf + rp_pos + 5) != rp_sum())
+    {
+	game->g_rp_astray = TRUE;
+	return FALSE;
+    }
+    rp_pos += 9;
+    game->g_rp_sums++;
+    return TRUE;
+}
+
+/*
+ * replay_feed:
+ *	Feed the keystrokes of a recording to sim_play().  It runs dry
+ *	at the end, or as soon as the game stops matching it.
+ */
+int
+replay_feed(void *arg)
+{
+    NOOP(arg);
+    while (rp_pos < rp_len && rp_buf[rp_pos] == RP_INTR)
+    {
+	rp_pos++;
+	quit(SIGINT);
+    }
+    if (turns >= rp_due)
+    {
+	if (!rp_check())
+	    return -1;
+	rp_due = turns + RP_EVERY;
+    }
+    if (rp_pos >= rp_len || rp_buf[rp_pos] == RP_SUM)
+	return -1;
+    game->g_rp_keys++;
+    return rp_buf[rp_pos++];
+}
+
+/*
+ * replay_end:
+ *	The replay is over; check the game ended the way the recording
+ *	did.  Returns FALSE if it went astray at any point.
+ */
+bool
+replay_end()
+{
+    if (game->g_rp_astray)
+	return FALSE;
+    if (rp_pos < rp_len && rp_buf[rp_pos] == RP_SUM)
+	return rp_check();
+    return TRUE;
+}
+#endif
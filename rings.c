@@ -186,7 +186,7 @@ ring_eat(int hand)
 char *
 ring_num(THING *obj)
 {
-    static char buf[10];
+    static TLOCAL char buf[10];
 
     if (!(obj->o_flags & ISKNOW))
 	return "";
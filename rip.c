@@ -39,6 +39,214 @@ static char *rip[] = {
     0
 };
 
+static char *reason[] = {
+    "killed",
+    "quit",
+    "A total winner",
+    "killed with Amulet"
+};
+
+/*
+ * sc_slot:
+ *	Find where a new score goes in the list: over her own record if
+ *	she beat it, otherwise at the end, or over the lowest score once
+ *	the file is full.  Returns -1 if it doesn't make the list.
+ */
+static int
+sc_slot(SCORE *list, int n, int amount, int flags, unsigned int uid)
+{
+    int i, low;
+
+    if (amount <= 0)
+	return -1;
+    low = -1;
+    for (i = 0; i < n; i++)
+    {
+	if (!allscore &&	/* only one score per nowin uid */
+	    flags != 2 && list[i].sc_uid == uid && list[i].sc_flags != 2)
+		return (amount > list[i].sc_score ? i : -1);
+	if (low < 0 || list[i].sc_score < list[low].sc_score
+	  || (list[i].sc_score == list[low].sc_score
+	    && list[i].sc_time > list[low].sc_time))
+	    low = i;
+    }
+    if (n < (int) maxscores)
+	return n;
+    if (low >= 0 && amount > list[low].sc_score)
+	return low;
+    return -1;
+}
+
+/*
+ * sc_cmp:
+ *	Order scores best first, and the older of two equal ones first
+ */
+static int
+sc_cmp(const void *a, const void *b)
+{
+    SCORE *s1 = *(SCORE **) a, *s2 = *(SCORE **) b;
+
+    if (s1->sc_score != s2->sc_score)
+	return (s1->sc_score > s2->sc_score ? -1 : 1);
+    if (s1->sc_time != s2->sc_time)
+	return (s1->sc_time < s2->sc_time ? -1 : 1);
+    return (s1 < s2 ? -1 : (s1 > s2));
+}
+
+/*
+ * sc_top:
+ *	Pick out the best k scores, best first, without sorting the rest
+ *	of the list: each one better than the worst picked so far goes
+ *	in its place among them.  Returns how many were picked.
+ */
+static int
+sc_top(SCORE *list, int n, SCORE **top, int k)
+{
+    SCORE *scp;
+    int i, lo, hi, mid, got;
+
+    got = 0;
+    for (i = 0; i < n; i++)
+    {
+	scp = &list[i];
+	if (got == k && sc_cmp(&scp, &top[k - 1]) > 0)
+	    continue;
+	lo = 0;
+	hi = got;
+	while (lo < hi)
+	{
+	    mid = (lo + hi) / 2;
+	    if (sc_cmp(&scp, &top[mid]) < 0)
+		hi = mid;
+	    else
+		lo = mid + 1;
+	}
+	if (got < k)
+	    got++;
+	memmove(&top[lo + 1], &top[lo], (got - 1 - lo) * sizeof *top);
+	top[lo] = scp;
+    }
+    return got;
+}
+
+/*
+ * sc_rank:
+ *	Where a score comes in the list, counting from 1
+ */
+static int
+sc_rank(SCORE *list, int n, SCORE *scp)
+{
+    SCORE *sp;
+    int i, rank;
+
+    rank = 1;
+    for (i = 0; i < n; i++)
+    {
+	sp = &list[i];
+	if (sc_cmp(&sp, &scp) < 0)
+	    rank++;
+    }
+    return rank;
+}
+
+/*
+ * pr_score:
+ *	Print one line of the list
+ */
+static void
+pr_score(int rank, SCORE *scp)
+{
+    printf("%2d %5d %s: %s on level %d", rank, scp->sc_score, scp->sc_name,
+	reason[scp->sc_flags & 3], scp->sc_level);
+    if (scp->sc_flags == 0 || scp->sc_flags == 3)
+	printf(" by %s", killname((char) scp->sc_monster, TRUE));
+}
+
+/*
+ * lg_put:
+ *	Put a number in a binary log record, least significant byte first
+ */
+static void
+lg_put(unsigned char *p, unsigned int v, int n)
+{
+    for (; n > 0; n--, v >>= 8)
+	*p++ = (unsigned char) (v & 0xff);
+}
+
+/*
+ * lg_copy:
+ *	Copy a name for the text log, where it mustn't break the fields
+ */
+static char *
+lg_copy(char *to, char *from, int size)
+{
+    char *sp;
+
+    for (sp = to; *from != '\0' && sp < &to[size - 1]; from++)
+	*sp++ = (*from == ':' || *from == '\n' ? '_' : *from);
+    *sp = '\0';
+    return to;
+}
+
+/*
+ * log_game:
+ *	Add the game to the end of the logs.  Each goes in one write, so
+ *	games ending at the same time can't get mixed up and there's no
+ *	need for the score file's lock.
+ */
+static void
+log_game(int amount, int flags, char monst)
+{
+    char buf[MAXSTR * 2 + 512], name[MAXSTR], killer[MAXSTR];
+    unsigned char rec[XL_RECSIZE];
+    unsigned int now;
+
+    now = (unsigned int) time(NULL);
+    if (flags == 0 || flags == 3)
+	lg_copy(killer, killname(monst, FALSE), MAXSTR);
+    else
+	killer[0] = '\0';
+    if (xlog >= 0)
+    {
+	sprintf(buf, "version=%s:seed=%u:uid=%u:name=%s:points=%d:gold=%d:"
+	    "flags=%d:death=%s:killer=%s:maxlvl=%d:deathlvl=%d:turns=%d:"
+	    "hp=%d:maxhp=%d:str=%u:maxstr=%u:exp=%d:explvl=%d:arm=%d:"
+	    "endtime=%u\n",
+	    release, (unsigned int) dnum, (unsigned int) md_getuid(),
+	    lg_copy(name, whoami, MAXSTR), amount, purse, flags,
+	    reason[flags & 3], killer, max_level, level, turns,
+	    pstats.s_hpt, pstats.s_maxhp, pstats.s_str, max_stats.s_str,
+	    pstats.s_exp, pstats.s_lvl, pstats.s_arm, now);
+	md_write(xlog, buf, strlen(buf));
+    }
+    if (xlogbin >= 0)
+    {
+	memset(rec, 0, XL_RECSIZE);
+	lg_put(rec, XL_MAGIC, 4);
+	lg_put(rec + 4, XL_RECSIZE, 2);
+	lg_put(rec + 6, XL_VERSION, 2);
+	lg_put(rec + 8, (unsigned int) dnum, 4);
+	lg_put(rec + 12, (unsigned int) md_getuid(), 4);
+	lg_put(rec + 16, now, 4);
+	lg_put(rec + 20, (unsigned int) amount, 4);
+	lg_put(rec + 24, (unsigned int) purse, 4);
+	lg_put(rec + 28, (unsigned int) turns, 4);
+	rec[32] = (unsigned char) flags;
+	rec[33] = (unsigned char) monst;
+	rec[34] = (unsigned char) max_level;
+	rec[35] = (unsigned char) level;
+	lg_put(rec + 36, (unsigned int) pstats.s_hpt, 2);
+	lg_put(rec + 38, (unsigned int) pstats.s_maxhp, 2);
+	rec[40] = (unsigned char) pstats.s_str;
+	rec[41] = (unsigned char) max_stats.s_str;
+	rec[42] = (unsigned char) pstats.s_lvl;
+	rec[43] = (unsigned char) pstats.s_arm;
+	lg_put(rec + 44, (unsigned int) pstats.s_exp, 4);
+	memcpy(rec + 48, whoami, strnlen(whoami, XL_NAMELEN - 1));
+	md_write(xlogbin, rec, XL_RECSIZE);
+    }
+}
+
 /*
  * score:
  *	Figure score and post it.
@@ -48,23 +256,27 @@ static char *rip[] = {
 void
 score(int amount, int flags, char monst)
 {
-    SCORE *scp;
-    int i;
-    SCORE *sc2;
-    SCORE *top_ten, *endp;
+    SCORE *scp, *sc2, *list, **top_ten;
+    int i, n, shown, slot;
 # ifdef MASTER
     int prflags = 0;
 # endif
     void (*fp)(int);
     unsigned int uid;
-    static char *reason[] = {
-	"killed",
-	"quit",
-	"A total winner",
-	"killed with Amulet"
-    };
+    bool locked;
 
+#ifdef ROGUE_SIM
+    /*
+     * A simulated game ends here, with nothing shown or written
+     */
+    game->g_result.sr_amount = amount;
+    game->g_result.sr_flags = flags;
+    game->g_result.sr_monst = monst;
+    sim_end(SIM_DONE);
+#endif
     start_score();
+    if (flags >= 0)
+	log_game(amount, flags, monst);
 
  if (flags >= 0
 #ifdef MASTER
@@ -87,19 +299,6 @@ score(int amount, int flags, char monst)
 	    delwin(hw);
     }
 
-    top_ten = (SCORE *) malloc(numscores * sizeof (SCORE));
-    endp = &top_ten[numscores];
-    for (scp = top_ten; scp < endp; scp++)
-    {
-	scp->sc_score = 0;
-	for (i = 0; i < MAXSTR; i++)
-	    scp->sc_name[i] = (unsigned char) rnd(255);
-	scp->sc_flags = RN;
-	scp->sc_level = RN;
-	scp->sc_monster = (unsigned short) RN;
-	scp->sc_uid = RN;
-    }
-
     signal(SIGINT, SIG_DFL);
 
 #ifdef MASTER
@@ -109,41 +308,28 @@ score(int amount, int flags, char monst)
 	else if (strcmp(prbuf, "edit") == 0)
 	    prflags = 2;
 #endif
-    rd_score(top_ten);
     /*
-     * Insert her in list if need be
+     * Hold the lock from reading the list to writing it back, so
+     * nobody else's score gets lost in between
+     */
+    locked = lock_sc();
+    n = rd_score(&list);
+    /*
+     * Put her in the list if need be.  Only her record changes, so
+     * only it gets written.
      */
     sc2 = NULL;
-    if (!noscore)
+    if (!noscore && list != NULL)
     {
 	uid = md_getuid();
-	for (scp = top_ten; scp < endp; scp++)
-	    if (amount > scp->sc_score)
-		break;
-	    else if (!allscore &&	/* only one score per nowin uid */
-		flags != 2 && scp->sc_uid == uid && scp->sc_flags != 2)
-		    scp = endp;
-	if (scp < endp)
+	if ((slot = sc_slot(list, n, amount, flags, uid)) >= 0)
 	{
-	    if (flags != 2 && !allscore)
-	    {
-		for (sc2 = scp; sc2 < endp; sc2++)
-		{
-		    if (sc2->sc_uid == uid && sc2->sc_flags != 2)
-			break;
-		}
-		if (sc2 >= endp)
-		    sc2 = endp - 1;
-	    }
-	    else
-		sc2 = endp - 1;
-	    while (sc2 > scp)
-	    {
-		*sc2 = sc2[-1];
-		sc2--;
-	    }
+	    if (slot == n)
+		n++;
+	    scp = &list[slot];
 	    scp->sc_score = amount;
-	    strncpy(scp->sc_name, whoami, MAXSTR);
+	    strncpy(scp->sc_name, whoami, SC_NAMELEN - 1);
+	    scp->sc_name[SC_NAMELEN - 1] = '\0';
 	    scp->sc_flags = flags;
 	    if (flags == 2)
 		scp->sc_level = max_level;
@@ -151,72 +337,83 @@ score(int amount, int flags, char monst)
 		scp->sc_level = level;
 	    scp->sc_monster = monst;
 	    scp->sc_uid = uid;
+	    scp->sc_time = (unsigned int) time(NULL);
 	    sc2 = scp;
+	    if (locked)
+	    {
+		fp = signal(SIGINT, SIG_IGN);
+		wr_score(list, n, slot);
+		signal(SIGINT, fp);
+	    }
 	}
     }
     /*
-     * Print the list
+     * Print the best of the list, best first
      */
+    top_ten = NULL;
+    if (n > 0 && (top_ten = malloc(numscores * sizeof *top_ten)) != NULL)
+	shown = sc_top(list, n, top_ten, (int) numscores);
+    else
+	shown = n = 0;
     if (flags != -1)
 	putchar('\n');
     printf("Top %s %s:\n", Numname, allscore ? "Scores" : "Rogueists");
     printf("   Score Name\n");
-    for (scp = top_ten; scp < endp; scp++)
+    for (i = 0; i < shown; i++)
     {
-	if (scp->sc_score) {
-	    if (sc2 == scp)
-            md_raw_standout();
-	    printf("%2d %5d %s: %s on level %d", (int) (scp - top_ten + 1),
-		scp->sc_score, scp->sc_name, reason[scp->sc_flags],
-		scp->sc_level);
-	    if (scp->sc_flags == 0 || scp->sc_flags == 3)
-		printf(" by %s", killname((char) scp->sc_monster, TRUE));
+	scp = top_ten[i];
+	if (sc2 == scp)
+	    md_raw_standout();
+	pr_score(i + 1, scp);
 #ifdef MASTER
-	    if (prflags == 1)
-	    {
-	    printf(" (%s)", md_getrealname(scp->sc_uid));
-	    }
-	    else if (prflags == 2)
+	if (prflags == 1)
+	{
+	printf(" (%s)", md_getrealname(scp->sc_uid));
+	}
+	else if (prflags == 2)
+	{
+	    fflush(stdout);
+	    (void) fgets(prbuf,10,stdin);
+	    if (prbuf[0] == 'd' && locked)
 	    {
-		fflush(stdout);
-		(void) fgets(prbuf,10,stdin);
-		if (prbuf[0] == 'd')
-		{
-		    for (sc2 = scp; sc2 < endp - 1; sc2++)
-			*sc2 = *(sc2 + 1);
-		    sc2 = endp - 1;
-		    sc2->sc_score = 0;
-		    for (i = 0; i < MAXSTR; i++)
-			sc2->sc_name[i] = (char) rnd(255);
-		    sc2->sc_flags = RN;
-		    sc2->sc_level = RN;
-		    sc2->sc_monster = (unsigned short) RN;
-		    scp--;
-		}
+		/*
+		 * The last record moves into the hole, and the best
+		 * are picked out again; the ones already shown stay
+		 * where they were
+		 */
+		slot = (int) (scp - list);
+		list[slot] = list[--n];
+		fp = signal(SIGINT, SIG_IGN);
+		wr_score(list, n, slot);
+		signal(SIGINT, fp);
+		sc2 = NULL;
+		shown = sc_top(list, n, top_ten, (int) numscores);
+		i--;
 	    }
-	    else
-#endif /* MASTER */
-                printf(".");
-	    if (sc2 == scp)
-		    md_raw_standend();
-            putchar('\n');
 	}
 	else
-	    break;
+#endif /* MASTER */
+	    printf(".");
+	if (sc2 == scp)
+	    md_raw_standend();
+	putchar('\n');
     }
     /*
-     * Update the list file
+     * If she made the list but not the top of it, say where
      */
-    if (sc2 != NULL)
+    if (sc2 != NULL && (i = sc_rank(list, n, sc2)) > shown)
     {
-	if (lock_sc())
-	{
-	    fp = signal(SIGINT, SIG_IGN);
-	    wr_score(top_ten);
-	    unlock_sc();
-	    signal(SIGINT, fp);
-	}
+	putchar('\n');
+	md_raw_standout();
+	pr_score(i, sc2);
+	printf(".");
+	md_raw_standend();
+	putchar('\n');
     }
+    if (locked)
+	unlock_sc();
+    free(top_ten);
+    free(list);
 }
 
 /*
@@ -229,10 +426,11 @@ death(char monst)
 {
     char **dp, *killer;
     struct tm *lt;
-    static time_t date;
+    static TLOCAL time_t date;
     struct tm *localtime();
 
     signal(SIGINT, SIG_IGN);
+    end_checkpoint();
     purse -= purse / 10;
     signal(SIGINT, leave);
     clear();
@@ -297,6 +495,7 @@ total_winner()
     int worth = 0;
     int oldpurse;
 
+    end_checkpoint();
     clear();
     standout();
     addstr("                                                               \n");
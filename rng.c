@@ -0,0 +1,182 @@
+/*
+ * Random number engines.  Every game carries its own generator, so
+ * games played side by side never disturb each other's numbers.
+ *
+ * Rogue: Exploring the Dungeons of Doom
+ * Copyright (C) 1980-1983, 1985, 1999 Michael Toy, Ken Arnold and Glenn Wichman
+ * All rights reserved.
+ *
+ * See the file LICENSE.TXT for full copyright and licensing information.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <curses.h>
+#include "rogue.h"
+
+static void	classic_seed(struct rng *rp, int s);
+static int	classic_rnd(struct rng *rp, int range);
+static void	fast_seed(struct rng *rp, int s);
+static int	fast_rnd(struct rng *rp, int range);
+
+/*
+ * The engines, by RNG_ number
+ */
+struct rng_engine {
+    char *e_name;
+    void (*e_seed)(struct rng *rp, int s);	/* Start from a seed */
+    int (*e_rnd)(struct rng *rp, int range);	/* 0 <= number < range */
+};
+
+static struct rng_engine rng_engines[NRNG] = {
+    { "classic",	classic_seed,	classic_rnd },
+    { "fast",		fast_seed,	fast_rnd },
+};
+
+/*
+ * rnd:
+ *	Pick a very random number.
+ */
+int
+rnd(int range)
+{
+    struct rng *rp = &game->g_rng;
+
+    return (*rng_engines[rp->r_engine].e_rnd)(rp, range);
+}
+
+/*
+ * rng_seed:
+ *	Start a generator over from the given seed, keeping its engine
+ */
+void
+rng_seed(struct rng *rp, int s)
+{
+    rp->r_seed = s;
+    (*rng_engines[rp->r_engine].e_seed)(rp, s);
+}
+
+/*
+ * rng_find:
+ *	Look up an engine by name
+ */
+int
+rng_find(char *name)
+{
+    int i;
+
+    for (i = 0; i < NRNG; i++)
+	if (strcmp(name, rng_engines[i].e_name) == 0)
+	    return i;
+    return -1;
+}
+
+/*
+ * rng_name:
+ *	The name of the engine a generator is using
+ */
+char *
+rng_name(struct rng *rp)
+{
+    return rng_engines[rp->r_engine].e_name;
+}
+
+/*
+ * The classic engine is the original 16 bit LCG (the old RN macro),
+ * so seeds from before there was a choice still give the same dungeons
+ */
+static void
+classic_seed(struct rng *rp, int s)
+{
+    NOOP(rp);			/* the seed is all the state there is */
+    NOOP(s);
+}
+
+static int
+classic_rnd(struct rng *rp, int range)
+{
+    /*
+     * rnd(0) does not use up a number.  The step is done unsigned so
+     * that its wraparound is well defined.
+     */
+    if (range == 0)
+	return 0;
+    rp->r_seed = (int) ((unsigned int) rp->r_seed * 11109 + 13849);
+    return ((rp->r_seed >> 16) & 0xffff) % range;
+}
+
+/*
+ * The fast engine is xoshiro128**: 32 bits a call from 128 bits of
+ * state, seeded through splitmix64 so that nearby seeds (like a run
+ * of dungeon numbers) still give unrelated streams.  That is how games
+ * played side by side get streams of their own: each is seeded from
+ * its own dungeon number, so any one of them can be played again
+ * alone.
+ */
+#define ROTL(x, k)	(((x) << (k)) | ((x) >> (32 - (k))))
+
+static unsigned int
+xoshiro(unsigned int *s)
+{
+    unsigned int result, t;
+
+    result = ROTL(s[1] * 5, 7) * 9;
+    t = s[1] << 9;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = ROTL(s[3], 11);
+    return result;
+}
+
+static unsigned long long
+splitmix(unsigned long long *sp)
+{
+    unsigned long long z;
+
+    z = (*sp += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static void
+fast_seed(struct rng *rp, int s)
+{
+    unsigned long long sm, z;
+    int i;
+
+    sm = (unsigned int) s;
+    for (i = 0; i < 4; i += 2)
+    {
+	z = splitmix(&sm);
+	rp->r_s[i] = (unsigned int) z;
+	rp->r_s[i + 1] = (unsigned int) (z >> 32);
+    }
+}
+
+/*
+ * fast_rnd:
+ *	Scale 32 random bits to the range with a multiply and a shift,
+ *	throwing away the few values that would make the result uneven
+ */
+static int
+fast_rnd(struct rng *rp, int range)
+{
+    unsigned long long m;
+    unsigned int r, t;
+
+    if (range == 0)
+	return 0;
+    r = (unsigned int) abs(range);
+    m = (unsigned long long) xoshiro(rp->r_s) * r;
+    if ((unsigned int) m < r)
+    {
+	t = -r % r;
+	while ((unsigned int) m < t)
+	    m = (unsigned long long) xoshiro(rp->r_s) * r;
+    }
+    return (int) (m >> 32);
+}
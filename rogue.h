@@ -12,10 +12,68 @@
 
 #include "extern.h"
 
+#ifdef ROGUE_SIM
+#include <setjmp.h>
+#endif
+
+/*
+ * Scratch storage that belongs to whichever game is running.  The
+ * simulator plays several games at once, one to a thread, and its
+ * curses.h says how to keep storage to a thread.
+ */
+#ifndef TLOCAL
+#ifdef ROGUE_SIM
+#error "the simulator's curses.h has to come before rogue.h"
+#endif
+#define TLOCAL
+#endif
+
 #undef lines 
 
 #define NOOP(x) (x += 0)
 #define CCHAR(x) ( (char) (x & A_CHARTEXT) )
+
+/*
+ * Drawing on stdscr goes through the shadow screen (screen.c), and
+ * reading it back comes from there without asking curses.  The w*
+ * forms go there too, and only touch the shadow when they are given
+ * stdscr.
+ */
+#undef addch
+#undef addstr
+#undef clear
+#undef clrtoeol
+#undef inch
+#undef mvaddch
+#undef mvaddstr
+#undef mvinch
+#undef mvprintw
+#undef printw
+#undef standend
+#undef standout
+#undef waddch
+#undef waddstr
+#undef wclrtoeol
+#undef mvwprintw
+#undef wgetnstr
+#define addch(c)	sh_addch(c)
+#define addstr(s)	sh_addstr(s)
+#define clear()		sh_clear()
+#define clrtoeol()	sh_clrtoeol()
+#define inch()		sh_inch()
+#define mvaddch(y,x,c)	(wmove(stdscr,y,x) == ERR ? ERR : sh_addch(c))
+#define mvaddstr(y,x,s)	(wmove(stdscr,y,x) == ERR ? ERR : sh_addstr(s))
+#define mvinch(y,x)	(wmove(stdscr,y,x) == ERR ? (chtype) ERR : sh_inch())
+#define mvprintw	sh_mvprintw
+#define printw		sh_printw
+#define standend()	sh_standout(FALSE)
+#define standout()	sh_standout(TRUE)
+#define waddch(w,c)	sh_waddch(w,c)
+#define waddstr(w,s)	sh_waddstr(w,s)
+#define wclrtoeol(w)	sh_wclrtoeol(w)
+#define mvwprintw	sh_mvwprintw
+#define wgetnstr(w,s,n)	sh_wgetnstr(w,s,n)
+
 /*
  * Maximum number of different things
  */
@@ -71,10 +129,11 @@
 #define ISRING(h,r)	(cur_ring[h] != NULL && cur_ring[h]->o_which == r)
 #define ISWEARING(r)	(ISRING(LEFT, r) || ISRING(RIGHT, r))
 #define ISMULT(type) 	(type == POTION || type == SCROLL || type == FOOD)
-#define INDEX(y,x)	(&places[((x) << 5) + (y)])
-#define chat(y,x)	(places[((x) << 5) + (y)].p_ch)
-#define flat(y,x)	(places[((x) << 5) + (y)].p_flags)
-#define moat(y,x)	(places[((x) << 5) + (y)].p_monst)
+#define INDEX(y,x)	((y) * MAXCOLS + (x))
+#define chat(y,x)	(places.p_ch[INDEX(y,x)])
+#define flat(y,x)	(places.p_flags[INDEX(y,x)])
+#define moat(y,x)	(mslot[places.p_mon[INDEX(y,x)]])
+#define set_moat(y,x,tp) (places.p_mon[INDEX(y,x)] = ((tp) == NULL ? 0 : ((THING *) (tp))->t_slot))
 #define unc(cp)		(cp).y, (cp).x
 #ifdef MASTER
 #define debug		if (wizard) msg
@@ -329,6 +388,7 @@ typedef struct {
 } coord;
 
 typedef unsigned int str_t;
+typedef unsigned long long hash_t;
 
 /*
  * Stuff about objects
@@ -354,6 +414,21 @@ struct room {
     coord r_exit[12];			/* Where the exits are */
 };
 
+/*
+ * A damage string like "1x4/1x4/2x7" compiled into its groups of dice,
+ * so that a swing does not have to parse it.  No more than three
+ * groups fit in s_dmg.
+ */
+#define MAXDICE		3
+
+struct dice {
+    int dc_cnt;				/* Number of groups */
+    struct {
+	short d_num;			/* How many to roll */
+	short d_sides;			/* Sides on each */
+    } dc_dice[MAXDICE];
+};
+
 /*
  * Structure describing a fighting being
  */
@@ -365,6 +440,7 @@ struct stats {
     int s_hpt;			/* Hit points */
     char s_dmg[13];			/* String describing damage done */
     int  s_maxhp;			/* Max hit points */
+    struct dice s_dice;			/* s_dmg, compiled */
 };
 
 /*
@@ -384,6 +460,7 @@ union thing {
 	struct room *_t_room;		/* Current room for thing */
 	union thing *_t_pack;		/* What the thing is carrying */
         int _t_reserved;
+	int _t_slot;			/* Where it is in mslot[] */
     } _t;
     struct {
 	union thing *_l_next, *_l_prev;	/* Next pointer in link */
@@ -394,6 +471,8 @@ union thing {
 	char _o_packch;			/* What character it is in the pack */
 	char _o_damage[8];		/* Damage if used like sword */
 	char _o_hurldmg[8];		/* Damage if thrown */
+	struct dice _o_dice;		/* _o_damage, compiled */
+	struct dice _o_hurldice;	/* _o_hurldmg, compiled */
 	int _o_count;			/* count for plural objects */
 	int _o_which;			/* Which object of a type it is */
 	int _o_hplus;			/* Plusses to hit */
@@ -420,6 +499,7 @@ typedef union thing THING;
 #define t_pack		_t._t_pack
 #define t_room		_t._t_room
 #define t_reserved      _t._t_reserved
+#define t_slot		_t._t_slot
 #define o_type		_o._o_type
 #define o_pos		_o._o_pos
 #define o_text		_o._o_text
@@ -427,6 +507,8 @@ typedef union thing THING;
 #define o_packch	_o._o_packch
 #define o_damage	_o._o_damage
 #define o_hurldmg	_o._o_hurldmg
+#define o_dice		_o._o_dice
+#define o_hurldice	_o._o_hurldice
 #define o_count		_o._o_count
 #define o_which		_o._o_which
 #define o_hplus		_o._o_hplus
@@ -439,13 +521,56 @@ typedef union thing THING;
 #define o_label		_o._o_label
 
 /*
- * describe a place on the level map
+ * THINGs are carved out of slabs a level at a time.  Everything made
+ * for a level comes out of the current arena; on the way to the next
+ * one the hero's pack is copied into the other arena and the old one
+ * is emptied all at once, keeping its slabs for the level after.
+ */
+#define SLABSIZE	64		/* THINGs in a slab */
+
+struct slab {
+    struct slab *s_next;		/* Next slab in the arena */
+    THING s_thing[SLABSIZE];		/* What gets handed out */
+};
+
+struct arena {
+    struct slab *a_slabs;		/* All of its slabs */
+    struct slab *a_cur;			/* Slab being handed out */
+    int a_used;				/* THINGs handed out of a_cur */
+    THING *a_free;			/* THINGs given back */
+};
+
+/*
+ * The level map, kept a line at a time in separate planes so that
+ * walking along a line walks through memory.  A monster on the map is
+ * kept as its slot number in mslot[]; slot 0 is always empty.  The
+ * room plane holds one more than the index in rooms[] of the room a
+ * spot is in, or 0 if it is in none.  The distance plane holds how
+ * many steps a monster needs to reach the hero from each spot, or
+ * FARAWAY if it cannot get there at all.
  */
 typedef struct {
-    char p_ch;
-    char p_flags;
-    THING *p_monst;
-} PLACE;
+    char p_ch[MAXLINES*MAXCOLS];		/* What is there */
+    char p_flags[MAXLINES*MAXCOLS];		/* F_ flags */
+    unsigned short p_mon[MAXLINES*MAXCOLS];	/* Monster's slot */
+    unsigned char p_room[MAXLINES*MAXCOLS];	/* Room it is in, plus 1 */
+    unsigned short p_dist[MAXLINES*MAXCOLS];	/* Steps to the hero */
+} MAP;
+
+#define FARAWAY		0xffff
+
+/*
+ * What it takes to walk the distance plane out from the hero (see
+ * flow_field()): which spots can be stood on and which ways a monster
+ * can step from each, and the spots still waiting to be walked out
+ */
+struct flow {
+    char f_walk[MAXLINES*MAXCOLS];		/* A monster can stand there */
+    unsigned char f_moves[MAXLINES*MAXCOLS];	/* Ways out, a bit each */
+    int f_queue[MAXLINES*MAXCOLS];		/* Spots left to walk out */
+    char f_queued[MAXLINES*MAXCOLS];		/* Spot is in f_queue */
+    int f_head, f_tail;				/* Ends of f_queue */
+};
 
 /*
  * Array containing information on all the various types of monsters
@@ -458,48 +583,419 @@ struct monster {
 };
 
 /*
- * External variables
+ * Fuse and daemon list entry.  Every fuse and daemon has a slot, and
+ * ones that go off on the same turn go off lowest slot first, with
+ * new ones taking the lowest free slot.  Fuses wait in a heap for the
+ * turn they go off on (BEFORE and AFTER turns are counted separately);
+ * daemons go off every turn, so they are just kept in slot order.
  */
+#define MAXDAEMONS 20			/* Slots to start with */
+#define NDFUNCS	14			/* Things that can be a fuse or daemon */
 
-extern bool	after, again, allscore, amulet, door_stop, fight_flush,
-		firstmove, has_hit, inv_describe, jump, kamikaze,
-		lower_msg, move_on, msg_esc, pack_used[],
-		passgo, playing, q_comm, running, save_msg, see_floor,
-		seenstairs, stat_msg, terse, to_death, tombstone;
+struct delayed_action {
+    int d_type;				/* BEFORE or AFTER, 0 if free */
+    void (*d_func)();			/* What to call */
+    int d_arg;				/* What to call it with */
+    int d_time;				/* Turn it goes off, or DAEMON */
+    int d_where;			/* Where it is in its heap or list */
+    int d_link;				/* Next slot (plus 1) with d_func */
+};
 
-extern char	dir_ch, file_name[], home[], huh[], *inv_t_name[],
-		l_last_comm, l_last_dir, last_comm, last_dir, *Numname,
-		outbuf[], *p_colors[], *r_stones[], *release, runch,
-		*s_names[], take, *tr_name[], *ws_made[], *ws_type[];
+struct sched {
+    struct delayed_action *s_slot;	/* Fuses and daemons by slot */
+    int s_nslot;			/* Size of s_slot */
+    unsigned int *s_used;		/* Which slots are taken */
+    int *s_fuse[2];			/* Fuses, soonest first */
+    int s_nfuse[2];
+    int *s_daemon[2];			/* Daemons, in slot order */
+    int s_ndaemon[2];
+    int s_ticks[2];			/* Turns gone by */
+    int s_first[NDFUNCS];		/* Lowest slot (plus 1) for each */
+};
 
-extern int	a_class[], count, food_left, hungry_state, inpack,
-		inv_type, lastscore, level, max_hit, max_level, mpos,
-		n_objs, no_command, no_food, no_move, noscore, ntraps, purse,
-		quiet, vf_hit;
+/*
+ * Status line as last drawn by status()
+ */
+struct stat_cache {
+    int hpwidth;
+    int s_hungry;
+    int s_lvl;
+    int s_pur;
+    int s_hp;
+    int s_arm;
+    str_t s_str;
+    int s_exp;
+};
 
-extern unsigned int	numscores;
+#define MAXMSG	(NUMCOLS - sizeof "--More--")
 
-extern int	dnum, e_levels[], seed;
+#ifdef ROGUE_SIM
+/*
+ * How a simulated game ended
+ */
+#define SIM_DONE	1	/* score() was called: died, quit or won */
+#define SIM_NOINPUT	2	/* the input feed ran dry */
+#define SIM_EXIT	3	/* the game tried to leave the program */
 
-extern WINDOW	*hw;
+struct sim_result {
+    int sr_end;				/* SIM_DONE, SIM_NOINPUT or SIM_EXIT */
+    int sr_amount;			/* Arguments score() was called with */
+    int sr_flags;
+    char sr_monst;
+    int sr_level;			/* Level the game ended on */
+    int sr_max_level;			/* Deepest level reached */
+    int sr_purse;			/* Gold at the end */
+    int sr_turns;			/* Turns played */
+};
+#endif
 
-extern coord	delta, oldpos, stairs;
+/*
+ * Random number generator state.  The engine is picked at the start
+ * of a game and saved with it.
+ */
+#define RNG_CLASSIC	0	/* the original LCG: old seeds replay */
+#define RNG_FAST	1	/* xoshiro128**, unbiased ranges */
+#define NRNG		2
 
-extern PLACE	places[];
+struct rng {
+    int r_engine;			/* RNG_ number */
+    int r_seed;				/* Classic state, or starting seed */
+    unsigned int r_s[4];		/* Fast engine state */
+};
+
+/*
+ * Everything that belongs to one game in progress.  All of the game
+ * code works on the game pointed to by "game", so a process can run
+ * any number of games by switching it between calls.
+ */
+struct game {
+    bool g_after;			/* True if we want after daemons */
+    bool g_again;			/* Repeating the last command */
+    bool g_amulet;			/* He found the amulet */
+    bool g_door_stop;			/* Stop running when we pass a door */
+    bool g_fight_flush;			/* True if toilet input */
+    bool g_flowchase;			/* Monsters chase by shortest path */
+    bool g_flow_ok;			/* p_dist leads to g_flow_at */
+    bool g_firstmove;			/* First move after setting door_stop */
+    bool g_has_hit;			/* Has a "hit" message pending in msg */
+    bool g_inv_describe;		/* Say which way items are being used */
+    bool g_jump;			/* Show running as series of jumps */
+    bool g_kamikaze;			/* to_death really to DEATH */
+    bool g_lower_msg;			/* Messages should start w/lower case */
+    bool g_move_on;			/* Next move shouldn't pick up items */
+    bool g_msg_esc;			/* Check for ESC from msg's --More-- */
+    bool g_passgo;			/* Follow passages */
+    bool g_playing;			/* True until he quits */
+    bool g_q_comm;			/* Are we executing a 'Q' command? */
+    bool g_running;			/* True if player is running */
+    bool g_save_msg;			/* Remember last msg */
+    bool g_see_floor;			/* Show the lamp illuminated floor */
+    bool g_seenstairs;			/* Have seen the stairs (for lsd) */
+    bool g_stat_msg;			/* Should status() print as a msg() */
+    bool g_terse;			/* True if we should be short */
+    bool g_to_death;			/* Fighting is to the death! */
+    bool g_tombstone;			/* Print out tombstone at end */
+    bool g_pack_used[26];		/* Is the character used in the pack? */
 
-extern THING	*cur_armor, *cur_ring[], *cur_weapon, *l_last_pick,
-		*last_pick, *lvl_obj, *mlist, player;
+    char g_ckpt_name[MAXSTR];		/* Where the last checkpoint went */
+    char g_dir_ch;			/* Direction from last get_dir() call */
+    char g_file_name[MAXSTR];		/* Save file name */
+    char g_fruit[MAXSTR];		/* Favorite fruit */
+    char g_huh[MAXSTR];			/* The last message printed */
+    char g_l_last_comm;			/* Last last_comm */
+    char g_l_last_dir;			/* Last last_dir */
+    char g_last_comm;			/* Last command typed */
+    char g_last_dir;			/* Last direction given */
+    char *g_p_colors[MAXPOTIONS];	/* Colors of the potions */
+    char g_prbuf[2*MAXSTR];		/* buffer for sprintfs */
+    char *g_r_stones[MAXRINGS];		/* Stone settings of the rings */
+    char g_runch;			/* Direction player is running */
+    char *g_s_names[MAXSCROLLS];	/* Names of the scrolls */
+    char g_take;			/* Thing she is taking */
+    char g_whoami[MAXSTR];		/* Name of player */
+    char *g_ws_made[MAXSTICKS];		/* What sticks are made of */
+    char *g_ws_type[MAXSTICKS];		/* Is it a wand or a staff */
 
-extern struct h_list	helpstr[];
+    int g_ckpt_due;			/* Turns until the next checkpoint */
+    int g_ckpt_every;			/* Turns between checkpoints */
+    int g_ckpt_pid;			/* Checkpoint being written */
+    int g_count;			/* Number of times to repeat command */
+    int g_dnum;				/* Dungeon number */
+    int g_food_left;			/* Amount of food in hero's stomach */
+    int g_hungry_state;			/* How hungry is he */
+    int g_inpack;			/* Number of things in pack */
+    int g_inv_type;			/* Type of inventory to use */
+    int g_lastscore;			/* Score before this turn */
+    int g_level;			/* What level she is on */
+    int g_max_hit;			/* Max damage done to her in to_death */
+    int g_max_level;			/* Deepest player has gone */
+    int g_mpos;				/* Where cursor is on top line */
+    int g_n_objs;			/* # items listed in inventory() call */
+    int g_no_command;			/* Number of turns asleep */
+    int g_no_food;			/* Number of levels without food */
+    int g_no_move;			/* Number of turns held in place */
+    int g_noscore;			/* Was a wizard sometime */
+    int g_ntraps;			/* Number of traps on this level */
+    int g_purse;			/* How much gold he has */
+    int g_quiet;			/* Number of quiet turns */
+    struct rng g_rng;			/* Random number generator */
+    int g_turns;			/* Turns played in the game */
+    int g_vf_hit;			/* Number of time flytrap has hit */
+
+    coord g_delta;			/* Change indicated to get_dir() */
+    coord g_flow_at;			/* Where the hero was for p_dist */
+    coord g_oldpos;			/* Position before last look() call */
+    coord g_stairs;			/* Location of staircase */
+
+    MAP g_places;			/* level map */
+    struct flow g_flow;			/* Working state for p_dist */
+    THING **g_mslot;			/* Monsters by slot number */
+    int g_nmslot;			/* Size of g_mslot */
+
+    unsigned char *g_shadow;		/* Shadow of stdscr, a byte a cell */
+    int g_sh_lines;			/* Lines in g_shadow */
+    int g_sh_cols;			/* Columns in g_shadow */
+    bool g_sh_so;			/* Drawing in standout */
+    int *g_sh_first;			/* First change on each line */
+    int *g_sh_last;			/* Last change on each line */
+    long g_anim_start;			/* When this turn's animation began */
+    int g_frame_time;			/* Milliseconds of animation a turn */
+    int g_frame_ms;			/* How long the last frame took */
+    int g_frame_skip;			/* Frames to leave out while running */
+    int g_frame_left;			/* Left to leave out before the next */
+
+    char g_watch_name[MAXSTR];		/* Where to publish frames */
+    char g_watch_at[MAXSTR];		/* What g_watch_map is mapped from */
+    void *g_watch_map;			/* The watch file, mapped */
+    size_t g_watch_size;		/* Size of g_watch_map */
+    unsigned int g_watch_n;		/* Frames published */
+
+    char g_rec_name[MAXSTR];		/* Where to record the game */
+    char g_rec_at[MAXSTR];		/* What is being recorded to */
+    int g_rec_limit;			/* Kilobytes to a recording file */
+    bool g_rec_on;			/* Recording */
+    bool g_rec_key;			/* Next frame draws everything */
+    int g_rec_fd;			/* Pipe to the writer */
+    int g_rec_pid;			/* The writer */
+    FILE *g_rec_file;			/* Recording, if there's no writer */
+    long g_rec_bytes;			/* Size of the recording so far */
+    char *g_rec_out;			/* Frame being put together */
+    unsigned char *g_rec_q;		/* Waiting for room in the pipe */
+    int g_rec_qlen;			/* Bytes in g_rec_q */
+
+    char g_replay_name[MAXSTR];		/* Where to record the keystrokes */
+    FILE *g_rp_file;			/* Keystrokes being recorded */
+    bool g_rp_head;			/* Its header has been written */
+    int g_rp_due;			/* Turn the next checksum is due */
+    bool g_replaying;			/* Playing a recording back */
+    unsigned char *g_rp_buf;		/* The recording being played */
+    size_t g_rp_len;			/* Size of g_rp_buf */
+    size_t g_rp_pos;			/* Where the next keystroke is */
+    long g_rp_keys;			/* Keystrokes played */
+    int g_rp_sums;			/* Checksums that matched */
+    bool g_rp_astray;			/* One didn't */
 
-extern struct room	*oldrp, passages[], rooms[];
+    hash_t g_hash;			/* Keys of the map and lists, summed */
+    hash_t g_hash_sum;			/* Hash of the game after the last turn */
+    bool g_hash_check;			/* Check the hash from scratch each turn */
+    int g_hash_bad;			/* Turns the check failed */
+    int g_hash_when;			/* First turn it failed */
 
-extern struct stats	max_stats;
+    THING *g_cur_armor;			/* What he is wearing */
+    THING *g_cur_ring[2];		/* Which rings are being worn */
+    THING *g_cur_weapon;		/* Which weapon he is weilding */
+    THING *g_l_last_pick;		/* Last last_pick */
+    THING *g_last_pick;			/* Last object picked in get_item() */
+    THING *g_lvl_obj;			/* List of objects on this level */
+    THING *g_mlist;			/* List of monsters on the level */
+    THING g_player;			/* His stats */
 
-extern struct monster	monsters[];
+    struct stats g_max_stats;		/* The maximum for the player */
 
-extern struct obj_info	arm_info[], pot_info[], ring_info[],
-			scr_info[], things[], ws_info[], weap_info[];
+    struct room *g_oldrp;		/* Roomin(&oldpos) */
+    struct room g_rooms[MAXROOMS];	/* One for each room -- A level */
+    struct room g_passages[MAXPASS];	/* One for each passage */
+
+    /*
+     * Tables which start out as copies of the ones in extern.c but
+     * get written on as the game goes along
+     */
+    struct monster g_monsters[26];
+    struct obj_info g_things[NUMTHINGS];
+    struct obj_info g_arm_info[MAXARMORS];
+    struct obj_info g_pot_info[MAXPOTIONS];
+    struct obj_info g_ring_info[MAXRINGS];
+    struct obj_info g_scr_info[MAXSCROLLS];
+    struct obj_info g_weap_info[MAXWEAPONS + 1];
+    struct obj_info g_ws_info[MAXSTICKS];
+
+    struct sched g_sched;		/* fuses and daemons */
+
+    int g_between;			/* Turns since last wanderer roll */
+    int g_group;			/* Next missile group number */
+    struct arena g_arena[2];		/* Where THINGs come from */
+    int g_cur_arena;			/* Which one this level uses */
+    int g_in_use;			/* THINGs in use */
+    int g_most_in_use;			/* Most THINGs ever in use */
+    int g_slabs;			/* Slabs allocated */
+    coord g_nh;				/* Where the hero is moving to */
+
+    /*
+     * Things that used to be kept in statics by the routines that
+     * use them
+     */
+    char g_msgbuf[2*MAXMSG+1];		/* msg() line being built */
+    int g_newpos;			/* Length of msgbuf */
+    struct stat_cache g_stat;		/* What status() last showed */
+    char g_countch;			/* command(): count being typed */
+    char g_direction;			/* command(): run direction */
+    bool g_newcount;			/* command(): count just started */
+    coord g_last_delt;			/* get_dir(): last delta */
+    int g_line_cnt;			/* add_line(): lines on the page */
+    bool g_newpage;			/* add_line(): started a new page */
+    char *g_lastfmt, *g_lastarg;	/* add_line(): last line added */
+    int g_maxlen;			/* add_line(): widest line */
+
+#ifdef ROGUE_SIM
+    int (*g_feed)(void *arg);		/* Where keystrokes come from */
+    void *g_feed_arg;			/* Passed to g_feed */
+    bool g_sim_wait;			/* Take --More-- keys from the feed */
+    jmp_buf g_sim_done;			/* Where to go when the game ends */
+    struct sim_result g_result;		/* How it ended */
+#endif
+};
+
+extern TLOCAL struct game	*game;
+
+#define after		(game->g_after)
+#define again		(game->g_again)
+#define amulet		(game->g_amulet)
+#define door_stop	(game->g_door_stop)
+#define fight_flush	(game->g_fight_flush)
+#define flowchase	(game->g_flowchase)
+#define firstmove	(game->g_firstmove)
+#define has_hit		(game->g_has_hit)
+#define inv_describe	(game->g_inv_describe)
+#define jump		(game->g_jump)
+#define kamikaze	(game->g_kamikaze)
+#define lower_msg	(game->g_lower_msg)
+#define move_on		(game->g_move_on)
+#define msg_esc		(game->g_msg_esc)
+#define passgo		(game->g_passgo)
+#define playing		(game->g_playing)
+#define q_comm		(game->g_q_comm)
+#define running		(game->g_running)
+#define save_msg	(game->g_save_msg)
+#define see_floor	(game->g_see_floor)
+#define seenstairs	(game->g_seenstairs)
+#define stat_msg	(game->g_stat_msg)
+#define terse		(game->g_terse)
+#define to_death	(game->g_to_death)
+#define tombstone	(game->g_tombstone)
+#define pack_used	(game->g_pack_used)
+#define dir_ch		(game->g_dir_ch)
+#define file_name	(game->g_file_name)
+#define fruit		(game->g_fruit)
+#define huh		(game->g_huh)
+#define l_last_comm	(game->g_l_last_comm)
+#define l_last_dir	(game->g_l_last_dir)
+#define last_comm	(game->g_last_comm)
+#define last_dir	(game->g_last_dir)
+#define p_colors	(game->g_p_colors)
+#define prbuf		(game->g_prbuf)
+#define r_stones	(game->g_r_stones)
+#define runch		(game->g_runch)
+#define s_names		(game->g_s_names)
+#define take		(game->g_take)
+#define whoami		(game->g_whoami)
+#define ws_made		(game->g_ws_made)
+#define ws_type		(game->g_ws_type)
+#define ckpt_due	(game->g_ckpt_due)
+#define ckpt_every	(game->g_ckpt_every)
+#define ckpt_name	(game->g_ckpt_name)
+#define ckpt_pid	(game->g_ckpt_pid)
+#define count		(game->g_count)
+#define dnum		(game->g_dnum)
+#define food_left	(game->g_food_left)
+#define frame_time	(game->g_frame_time)
+#define hungry_state	(game->g_hungry_state)
+#define inpack		(game->g_inpack)
+#define inv_type	(game->g_inv_type)
+#define lastscore	(game->g_lastscore)
+#define level		(game->g_level)
+#define max_hit		(game->g_max_hit)
+#define max_level	(game->g_max_level)
+#define mpos		(game->g_mpos)
+#define n_objs		(game->g_n_objs)
+#define no_command	(game->g_no_command)
+#define no_food		(game->g_no_food)
+#define no_move		(game->g_no_move)
+#define noscore		(game->g_noscore)
+#define ntraps		(game->g_ntraps)
+#define purse		(game->g_purse)
+#define replay_name	(game->g_replay_name)
+#define replaying	(game->g_replaying)
+#define quiet		(game->g_quiet)
+#define seed		(game->g_rng.r_seed)
+#define turns		(game->g_turns)
+#define vf_hit		(game->g_vf_hit)
+#define delta		(game->g_delta)
+#define oldpos		(game->g_oldpos)
+#define stairs		(game->g_stairs)
+#define places		(game->g_places)
+#define mslot		(game->g_mslot)
+#define cur_armor	(game->g_cur_armor)
+#define cur_ring	(game->g_cur_ring)
+#define cur_weapon	(game->g_cur_weapon)
+#define l_last_pick	(game->g_l_last_pick)
+#define last_pick	(game->g_last_pick)
+#define lvl_obj		(game->g_lvl_obj)
+#define mlist		(game->g_mlist)
+#define player		(game->g_player)
+#define max_stats	(game->g_max_stats)
+#define oldrp		(game->g_oldrp)
+#define rooms		(game->g_rooms)
+#define passages	(game->g_passages)
+#define monsters	(game->g_monsters)
+#define things		(game->g_things)
+#define arm_info	(game->g_arm_info)
+#define pot_info	(game->g_pot_info)
+#define ring_info	(game->g_ring_info)
+#define scr_info	(game->g_scr_info)
+#define weap_info	(game->g_weap_info)
+#define ws_info		(game->g_ws_info)
+#define between		(game->g_between)
+#define group		(game->g_group)
+#define nh		(game->g_nh)
+
+/*
+ * External variables
+ */
+
+extern bool	allscore, got_ltc, in_shell;
+
+extern char	home[], *inv_t_name[], *Numname, *release, *tr_name[];
+
+extern int	a_class[], e_levels[], orig_dsusp;
+
+extern unsigned int	numscores;
+extern unsigned int	maxscores;
+
+extern int	xlog, xlogbin;
+
+extern FILE	*scoreboard;
+
+extern TLOCAL WINDOW	*hw;
+
+extern struct h_list	helpstr[];
+
+extern struct monster	def_monsters[];
+
+extern struct obj_info	def_arm_info[], def_pot_info[], def_ring_info[],
+			def_scr_info[], def_things[], def_ws_info[],
+			def_weap_info[];
+
+extern void	(*d_funcs[])();
 
 /*
  * Function types
@@ -514,6 +1010,8 @@ void	add_pass();
 void	add_str(str_t *sp, int amt);
 void	accnt_maze(int y, int x, int ny, int nx);
 void	aggravate();
+void	anim_frame();
+void	anim_turn();
 int	attack(THING *mp);
 void	badcheck(char *name, struct obj_info *info, int bound);
 void	bounce(THING *weap, char *mname, bool noend);
@@ -523,17 +1021,22 @@ bool	cansee(int y, int x);
 int	center(char *str);
 void	chg_str(int amt);
 void	check_level();
+void	checkpoint();
 void	conn(int r1, int r2);
 void	command();
 void	create_obj();
 
 void	current(THING *cur, char *how, char *where);
 void	d_level();
+void	d_restore(int i, int type, void (*func)(), int arg, int time);
 void	death(char monst);
 char	death_monst();
 void	dig(int y, int x);
 void	discard(THING *item);
+void	drop_level();
 void	discovered();
+int	d_func_id(void (*func)());
+int	d_left(struct delayed_action *dev);
 int	dist(int y1, int x1, int y2, int x2);
 int	dist_cp(coord *c1, coord *c2);
 int	do_chase(THING *th);
@@ -554,8 +1057,13 @@ void	drain();
 void	draw_room(struct room *rp);
 void	drop();
 void	eat();
+void	end_frame();
+void	end_checkpoint();
 size_t  encread(char *start, size_t size, FILE *inf);
 size_t	encwrite(char *start, size_t size, FILE *outf);
+size_t	saveread(char *start, size_t size);
+size_t	savewrite(char *start, size_t size);
+size_t	savepos();
 int	endmsg();
 void	enter_room(coord *cp);
 void	erase_lamp(coord *pos, struct room *rp);
@@ -563,20 +1071,34 @@ int	exp_add(THING *tp);
 void	extinguish(void (*func)());
 void	fall(THING *obj, bool pr);
 void	fire_bolt(coord *start, coord *dir, char *name);
+void	flow_field();
+void	flow_open(int y, int x);
 char	floor_at();
+void	free_screen();
+void	free_slot(THING *tp);
 void	flush_type();
+int	fast_forward();
 int	fight(coord *mp, THING *weap, bool thrown);
 void	fix_stick(THING *cur);
+void	free_sched();
+void	free_things();
 void	fuse(void (*func)(), int arg, int time, int type);
 bool	get_dir();
 int	gethand();
 void	give_pack(THING *tp);
+void	hash_attach(THING **list, THING *tp);
+void	hash_detach(THING **list, THING *tp);
+hash_t	hash_full();
+hash_t	hash_game();
+void	hash_reset();
+void	hash_turn();
 void	help();
 void	hit(char *er, char *ee, bool noend);
 void	horiz(struct room *rp, int starty);
 void	leave_room(coord *cp);
 void	lengthen(void (*func)(), int xtime);
 void	look(bool wakeup);
+void	mark_room(struct room *rp);
 int	hit_monster(int y, int x, THING *obj);
 void	identify();
 void	illcom(int ch);
@@ -602,9 +1124,12 @@ int	msg(char *fmt, ...);
 void	nameit(THING *obj, char *type, char *which, struct obj_info *op, char *(*prfunc)(THING *));
 void	new_level();
 void	new_monster(THING *tp, char type, coord *cp);
+void	new_slot(THING *tp);
 void	numpass(int y, int x);
 void	option();
+void	open_log();
 void	open_score();
+void	opt_string(char *buf, size_t size);
 void	parse_opts(char *str);
 void 	passnum();
 char	*pick_color(char *col);
@@ -614,6 +1139,7 @@ void	picky_inven();
 void	pr_spec(struct obj_info *info, int nitems);
 void	pr_list();
 void	put_bool(void *b);
+void	put_int(void *ip);
 void	put_inv_t(void *ip);
 void	put_str(void *str);
 void	put_things();
@@ -622,8 +1148,14 @@ void	quaff();
 void	raise_level();
 char	randmonster(bool wander);
 void	read_scroll();
+void	rec_close();
+void	rec_frame();
 void    relocate(THING *th, coord *new_loc);
 void	remove_mon(coord *mp, THING *tp, bool waskill);
+void	replay_close();
+void	replay_intr();
+void	replay_key(int ch);
+void	replay_start();
 void	reset_last();
 bool	restore(char *file, char **envp);
 int	ring_eat(int hand);
@@ -631,18 +1163,39 @@ void	ring_on();
 void	ring_off();
 int	rnd(int range);
 int	rnd_room();
+int	rng_find(char *name);
+char	*rng_name(struct rng *rp);
+void	rng_seed(struct rng *rp, int s);
 int	roll(int number, int sides);
 int	rs_save_file(FILE *savef);
 int	rs_restore_file(FILE *inf);
 void	runto(coord *runner);
 void	rust_armor(THING *arm);
 int	save(int which);
-void	save_file(FILE *savef);
+int	sh_addch(chtype c);
+int	sh_addstr(const char *s);
+int	sh_clear();
+int	sh_clrtoeol();
+int	sh_mvprintw(int y, int x, const char *fmt, ...);
+int	sh_printw(const char *fmt, ...);
+void	sh_clean();
+int	sh_standout(bool on);
+int	sh_waddch(WINDOW *win, chtype c);
+int	sh_waddstr(WINDOW *win, const char *s);
+int	sh_wclrtoeol(WINDOW *win);
+int	sh_mvwprintw(WINDOW *win, int y, int x, const char *fmt, ...);
+int	sh_wgetnstr(WINDOW *win, char *str, int n);
+void	sh_wrefresh(WINDOW *win);
+bool	save_file(FILE *savef);
 void	save_game();
+void	savecrypt(size_t pos, size_t size);
+void	saveseek(size_t pos);
 int	save_throw(int which, THING *tp);
 void	score(int amount, int flags, char monst);
 void	search();
+void	set_dice(struct dice *dc, char *str);
 void	set_know(THING *obj, struct obj_info *info);
+void	set_chat(int y, int x, char ch);
 void	set_oldch(THING *tp, coord *cp);
 void	setup();
 void	shell();
@@ -652,6 +1205,7 @@ void	show_win(char *message);
 int	sign(int nm);
 int	spread(int nm);
 void	start_daemon(void (*func)(), int arg, int type);
+void	start_game();
 void	start_score();
 void	status();
 int	step_ok(int ch);
@@ -671,6 +1225,8 @@ void	wait_for(int ch);
 THING  *wake_monster(int y, int x);
 void	wanderer();
 void	waste_time();
+void	watch_close();
+void	watch_frame();
 void	wear();
 void	whatis(bool insist, int type);
 void	wield();
@@ -679,13 +1235,19 @@ bool	chase(THING *tp, coord *ee);
 bool	diag_ok(coord *sp, coord *ep);
 bool	dropcheck(THING *obj);
 bool	fallpos(coord *pos, coord *newpos);
+bool	flow_chase(THING *tp);
 bool	find_floor(struct room *rp, coord *cp, int limit, bool monst);
 bool	is_magic(THING *obj);
 bool    is_symlink(char *sp); 
 bool	levit_check();
 bool	pack_room(bool from_floor, THING *obj);
 bool	roll_em(THING *thatt, THING *thdef, THING *weap, bool hurl);
+bool	save_write(FILE *savef);
+bool	saveflush(FILE *outf);
+bool	saveload(FILE *inf);
 bool	see_monst(THING *mp);
+bool	skip_frame();
+bool	sh_dirty(int y, int *firstp, int *lastp);
 bool	seen_stairs();
 bool	turn_ok(int y, int x);
 bool	turn_see(bool turn_off);
@@ -704,10 +1266,12 @@ char	*inv_name(THING *obj, bool drop);
 char	*nullstr(THING *ignored);
 char	*num(int n1, int n2, char type);
 char	*ring_num(THING *obj);
+char	*saveat(size_t pos, size_t size);
 char	*set_mname(THING *tp);
 char	*vowelstr(char *str);
 
 int	get_bool(void *vp, WINDOW *win);
+int	get_int(void *vp, WINDOW *win);
 int	get_inv_t(void *vp, WINDOW *win);
 int	get_num(void *vp, WINDOW *win);
 int	get_sf(void *vp, WINDOW *win);
@@ -723,26 +1287,27 @@ THING	*leave_pack(THING *obj, bool newobj, bool all);
 THING	*new_item();
 THING	*new_thing();
 
-struct room	*roomin(coord *cp);
+chtype	sh_inch();
+unsigned char	*sh_at(int *linesp, int *colsp);
 
-#define MAXDAEMONS 20
+struct game	*new_game();
+void	free_game(struct game *g);
 
-extern struct delayed_action {
-    int d_type;
-    void (*d_func)();
-    int d_arg;
-    int d_time;
-} d_list[MAXDAEMONS];
+#ifdef ROGUE_SIM
+void	sim_end(int how);
+int	sim_play(int dungeon, int (*feed)(void *arg), void *arg);
+bool	replay_end();
+int	replay_feed(void *arg);
+bool	replay_load(char *file, int *dnump);
+#endif
+
+struct room	*roomin(coord *cp);
 
 typedef struct {
     char	*st_name;
     int		st_value;
 } STONE;
 
-extern int      total;
-extern int      between;
-extern int      group;
-extern coord    nh;
 extern char     *rainbow[];
 extern int      cNCOLORS;
 extern STONE    stones[];
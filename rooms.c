@@ -34,7 +34,7 @@ do_rooms()
     struct room *rp;
     THING *tp;
     int left_out;
-    static coord top;
+    static TLOCAL coord top;
     coord bsze;				/* maximum room size */
     coord mp;
 
@@ -112,6 +112,7 @@ do_rooms()
 		rp->r_pos.x = top.x + rnd(bsze.x - rp->r_max.x);
 		rp->r_pos.y = top.y + rnd(bsze.y - rp->r_max.y);
 	    } until (rp->r_pos.y != 0);
+	mark_room(rp);
 	draw_room(rp);
 	/*
 	 * Put the gold in
@@ -143,6 +144,29 @@ do_rooms()
     }
 }
 
+/*
+ * mark_room:
+ *	Mark the spots a room covers in the room plane of the map, so
+ *	that roomin() doesn't have to go looking.  Where rooms overlap
+ *	the first one in rooms[] keeps the spot.
+ */
+void
+mark_room(struct room *rp)
+{
+    register int x, y;
+    register unsigned char *rmp;
+
+    for (y = max(rp->r_pos.y, 0);
+	y <= rp->r_pos.y + rp->r_max.y && y < MAXLINES; y++)
+    {
+	rmp = &places.p_room[INDEX(y, 0)];
+	for (x = max(rp->r_pos.x, 0);
+	    x <= rp->r_pos.x + rp->r_max.x && x < MAXCOLS; x++)
+		if (rmp[x] == 0 || rmp[x] > rp - rooms + 1)
+		    rmp[x] = (unsigned char) (rp - rooms + 1);
+    }
+}
+
 /*
  * draw_room:
  *	Draw a box around a room and lay down the floor for normal
@@ -205,9 +229,9 @@ horiz(struct room *rp, int starty)
  *	Dig a maze
  */
 
-static int	Maxy, Maxx, Starty, Startx;
+static TLOCAL int	Maxy, Maxx, Starty, Startx;
 
-static SPOT	maze[NUMLINES/3+1][NUMCOLS/3+1];
+static TLOCAL SPOT	maze[NUMLINES/3+1][NUMCOLS/3+1];
 
 
 void
@@ -215,7 +239,7 @@ do_maze(struct room *rp)
 {
     SPOT *sp;
     int starty, startx;
-    static coord pos;
+    static TLOCAL coord pos;
 
     for (sp = &maze[0][0]; sp <= &maze[NUMLINES / 3][NUMCOLS / 3]; sp++)
     {
@@ -245,7 +269,7 @@ dig(int y, int x)
 {
     coord *cp;
     int cnt, newy, newx, nexty = 0, nextx = 0;
-    static coord pos;
+    static TLOCAL coord pos;
     static coord del[4] = {
 	{2, 0}, {-2, 0}, {0, 2}, {0, -2}
     };
@@ -334,7 +358,7 @@ rnd_pos(struct room *rp, coord *cp)
 bool
 find_floor(struct room *rp, coord *cp, int limit, bool monst)
 {
-    PLACE *pp;
+    int pp;
     int cnt;
     char compchar = 0;
     bool pickroom;
@@ -357,10 +381,10 @@ find_floor(struct room *rp, coord *cp, int limit, bool monst)
 	pp = INDEX(cp->y, cp->x);
 	if (monst)
 	{
-	    if (pp->p_monst == NULL && step_ok(pp->p_ch))
+	    if (places.p_mon[pp] == 0 && step_ok(places.p_ch[pp]))
 		return TRUE;
 	}
-	else if (pp->p_ch == compchar)
+	else if (places.p_ch[pp] == compchar)
 	    return TRUE;
     }
 }
@@ -420,7 +444,7 @@ enter_room(coord *cp)
 void
 leave_room(coord *cp)
 {
-    PLACE *pp;
+    int pp;
     struct room *rp;
     int y, x;
     char floor;
@@ -464,7 +488,7 @@ leave_room(coord *cp)
 			    break;
 			}
                         pp = INDEX(y,x);
-			addch(pp->p_ch == DOOR ? DOOR : floor);
+			addch(places.p_ch[pp] == DOOR ? DOOR : floor);
 		    }
 	    }
 	}
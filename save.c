@@ -20,11 +20,17 @@
 #include "rogue.h"
 #include "score.h"
 
+#define SV_SIZELINE	80		/* Bytes in the screen size line */
+#define SV_SECTIONS	"RGSV"		/* rs_save_file()'s magic, in the file */
+
 typedef struct stat STAT;
 
-extern char version[], encstr[];
+extern char version[], oversion[], encstr[];
+
+static TLOCAL STAT sbuf;
 
-static STAT sbuf;
+static void save_free();
+static bool ckpt_write();
 
 /*
  * save_game:
@@ -82,6 +88,16 @@ quit_it:
 	}
 	mpos = 0;
 gotfile:
+	/*
+	 * A replay ends where the game was saved, leaving the files be
+	 */
+	if (replaying)
+	    my_exit(0);
+	/*
+	 * A checkpoint there is ours, not a file to ask about
+	 */
+	if (strcmp(buf, ckpt_name) == 0)
+	    end_checkpoint();
 	/*
 	 * test to see if the file exists
 	 */
@@ -108,8 +124,10 @@ gotfile:
 	    msg(strerror(errno));
     } while (savef == NULL);
 
-    save_file(savef);
-    /* NOTREACHED */
+    end_checkpoint();
+    if (!save_file(savef))
+	msg("couldn't save the game: %s",
+	    errno != 0 ? strerror(errno) : "write error");
 }
 
 /*
@@ -125,6 +143,7 @@ auto_save(int sig)
     NOOP(sig);
 
     md_ignoreallsignals();
+    end_checkpoint();
     if (file_name[0] != '\0' && ((savef = fopen(file_name, "w")) != NULL ||
 	(md_unlink_open_file(file_name, savef) >= 0 && (savef = fopen(file_name, "w")) != NULL)))
 	    save_file(savef);
@@ -133,25 +152,131 @@ auto_save(int sig)
 
 /*
  * save_file:
- *	Write the saved game on the file
+ *	Write the saved game on the file and leave.  If it couldn't be
+ *	written, what there is of it is thrown away and FALSE comes back,
+ *	with the game still going.
  */
 
-void
+bool
 save_file(FILE *savef)
 {
-    char buf[80];
+    bool ok;
+
+    md_chmod(file_name, 0400);
+    errno = 0;
+    ok = save_write(savef);
+    if (fclose(savef) != 0)
+	ok = FALSE;
+    if (!ok)
+    {
+	md_unlink(file_name);
+	return FALSE;
+    }
     mvcur(0, COLS - 1, LINES - 1, 0); 
     putchar('\n');
     endwin();
     resetltchars();
-    md_chmod(file_name, 0400);
+    my_exit(0);
+    /* NOTREACHED */
+    return TRUE;
+}
+
+/*
+ * save_write:
+ *	Put the whole game out on a file.  Returns FALSE if it couldn't.
+ */
+bool
+save_write(FILE *savef)
+{
+    char buf[80];
+    bool ok;
+
+    save_free();
     encwrite(version, strlen(version)+1, savef);
+    memset(buf, 0, sizeof buf);
     sprintf(buf,"%d x %d\n", LINES, COLS);
-    encwrite(buf,80,savef);
-    rs_save_file(savef);
-    fflush(savef);
-    fclose(savef);
-    exit(0);
+    savewrite(buf, SV_SIZELINE);
+    savecrypt(0, SV_SIZELINE);
+    ok = (bool) (rs_save_file(savef) == 0);
+    return (bool) (saveflush(savef) && ok);
+}
+
+/*
+ * checkpoint:
+ *	Every so many turns save the game in the background, so it
+ *	isn't lost if we are killed without any warning.  A child
+ *	process does the writing, so play goes on without waiting for
+ *	the disk.
+ */
+void
+checkpoint()
+{
+    int pid;
+
+    if (ckpt_every <= 0 || file_name[0] == '\0' || replaying
+      || --ckpt_due > 0)
+	return;
+    /*
+     * If the last one is still being written, try again next turn
+     */
+    if (ckpt_pid != 0 && !md_child_done(ckpt_pid, FALSE))
+	return;
+    ckpt_pid = 0;
+    ckpt_due = ckpt_every;
+    strcpy(ckpt_name, file_name);
+    if ((pid = md_fork()) == 0)
+    {
+	md_ignoreallsignals();
+	md_child_exit(ckpt_write() ? 0 : 1);
+    }
+    else if (pid > 0)
+	ckpt_pid = pid;
+    else
+	ckpt_write();
+}
+
+/*
+ * ckpt_write:
+ *	Write a checkpoint on a temporary file, then rename it over the
+ *	old one, so there is always a whole one there
+ */
+static bool
+ckpt_write()
+{
+    FILE *savef;
+    char tmp[MAXSTR + 5];
+    bool ok;
+
+    sprintf(tmp, "%s.tmp", ckpt_name);
+    md_unlink(tmp);
+    if ((savef = fopen(tmp, "w")) == NULL)
+	return FALSE;
+    md_chmod(tmp, 0400);
+    ok = save_write(savef);
+    if (fclose(savef) != 0)
+	ok = FALSE;
+    if (!ok || md_rename(tmp, ckpt_name) != 0)
+    {
+	md_unlink(tmp);
+	return FALSE;
+    }
+    return TRUE;
+}
+
+/*
+ * end_checkpoint:
+ *	Wait for any checkpoint still being written and get rid of it,
+ *	because the game is over or is being saved for real
+ */
+void
+end_checkpoint()
+{
+    if (ckpt_pid != 0)
+	md_child_done(ckpt_pid, TRUE);
+    ckpt_pid = 0;
+    if (ckpt_name[0] != '\0')
+	md_unlink(ckpt_name);
+    ckpt_name[0] = '\0';
 }
 
 /*
@@ -183,13 +308,12 @@ restore(char *file, char **envp)
     syml = is_symlink(file);
 
     fflush(stdout);
-    encread(buf, (unsigned) strlen(version) + 1, inf);
-    if (strcmp(buf, version) != 0)
+    if (!saveload(inf))
     {
 	printf("Sorry, saved game is out of date.\n");
 	return FALSE;
     }
-    encread(buf,80,inf);
+    saveread(buf, SV_SIZELINE);
     sscanf(buf,"%d x %d\n", &lines, &cols);
 
     initscr();                          /* Start up cursor package */
@@ -213,7 +337,14 @@ restore(char *file, char **envp)
     hw = newwin(LINES, COLS, 0, 0);
     setup();
 
-    rs_restore_file(inf);
+    if (rs_restore_file(inf) != 0)
+    {
+	save_free();
+	endwin();
+	printf("Sorry, saved game is damaged.\n");
+	return FALSE;
+    }
+    save_free();
     /*
      * we do not close the file so that we will have a hold of the
      * inode for as long as possible
@@ -266,6 +397,80 @@ restore(char *file, char **envp)
     return(0);
 }
 
+/*
+ * The save and score files are scrambled by XORing each byte with a
+ * keystream made from encstr and statlist.  The keystream does not
+ * depend on what is being scrambled, so a cipher can keep its place
+ * in it from one call to the next and do a whole buffer at a time.
+ */
+#define KEYBLOCK	256		/* Keystream made at a time */
+
+struct cipher {
+    int c_e1, c_e2;			/* Where it is in encstr, statlist */
+    unsigned char c_fb;			/* Feedback byte */
+};
+
+/*
+ * cipher_init:
+ *	Start a cipher at the top of the keystream
+ */
+static void
+cipher_init(struct cipher *cp)
+{
+    cp->c_e1 = 0;
+    cp->c_e2 = 0;
+    cp->c_fb = 0;
+}
+
+/*
+ * cipher_run:
+ *	Scramble (or unscramble) a buffer in place, carrying on from
+ *	wherever the cipher is in the keystream
+ */
+static void
+cipher_run(struct cipher *cp, char *start, size_t size)
+{
+    extern char statlist[];
+    unsigned char key[KEYBLOCK];
+    unsigned long w, k;
+    register int e1, e2, i, n;
+    register unsigned char fb;
+
+    e1 = cp->c_e1;
+    e2 = cp->c_e2;
+    fb = cp->c_fb;
+    while (size > 0)
+    {
+	n = (size < KEYBLOCK) ? (int) size : KEYBLOCK;
+	for (i = 0; i < n; i++)
+	{
+	    key[i] = (unsigned char) (encstr[e1] ^ statlist[e2] ^ fb);
+	    fb += (unsigned char) (encstr[e1] * statlist[e2]);
+	    if (encstr[++e1] == '\0')
+		e1 = 0;
+	    if (statlist[++e2] == '\0')
+		e2 = 0;
+	}
+	/*
+	 * Then XOR it in a word at a time
+	 */
+	for (i = 0; i + (int) sizeof w <= n; i += sizeof w)
+	{
+	    memcpy(&w, &start[i], sizeof w);
+	    memcpy(&k, &key[i], sizeof k);
+	    w ^= k;
+	    memcpy(&start[i], &w, sizeof w);
+	}
+	for (; i < n; i++)
+	    start[i] ^= key[i];
+	start += n;
+	size -= n;
+    }
+    cp->c_e1 = e1;
+    cp->c_e2 = e2;
+    cp->c_fb = fb;
+}
+
 /*
  * encwrite:
  *	Perform an encrypted write
@@ -274,29 +479,20 @@ restore(char *file, char **envp)
 size_t
 encwrite(char *start, size_t size, FILE *outf)
 {
-    char *e1, *e2, fb;
-    int temp;
-    extern char statlist[];
-    size_t o_size = size;
-    e1 = encstr;
-    e2 = statlist;
-    fb = 0;
+    struct cipher c;
+    char buf[BUFSIZ];
+    size_t n, done;
 
-    while(size)
+    cipher_init(&c);
+    for (done = 0; done < size; done += n)
     {
-	if (putc(*start++ ^ *e1 ^ *e2 ^ fb, outf) == EOF)
-            break;
-
-	temp = *e1++;
-	fb = fb + ((char) (temp * *e2++));
-	if (*e1 == '\0')
-	    e1 = encstr;
-	if (*e2 == '\0')
-	    e2 = statlist;
-	size--;
+	n = (size - done < sizeof buf) ? size - done : sizeof buf;
+	memcpy(buf, start + done, n);
+	cipher_run(&c, buf, n);
+	if (fwrite(buf, 1, n, outf) != n)
+	    break;
     }
-
-    return(o_size - size);
+    return(done);
 }
 
 /*
@@ -306,85 +502,421 @@ encwrite(char *start, size_t size, FILE *outf)
 size_t
 encread(char *start, size_t size, FILE *inf)
 {
-    char *e1, *e2, fb;
-    int temp;
+    struct cipher c;
     size_t read_size;
-    extern char statlist[];
-
-    fb = 0;
 
     if ((read_size = fread(start,1,size,inf)) == 0 || read_size == -1)
 	return(read_size);
 
-    e1 = encstr;
-    e2 = statlist;
-
-    while (size--)
-    {
-	*start++ ^= *e1 ^ *e2 ^ fb;
-	temp = *e1++;
-	fb = fb + (char)(temp * *e2++);
-	if (*e1 == '\0')
-	    e1 = encstr;
-	if (*e2 == '\0')
-	    e2 = statlist;
-    }
+    cipher_init(&c);
+    cipher_run(&c, start, read_size);
 
     return(read_size);
 }
 
-static char scoreline[100];
 /*
- * read_scrore
- *	Read in the score file
+ * A saved game is put together in memory and written out all at once.
+ * Only the screen size line and the data in each section are
+ * scrambled, each from the top of the keystream, so the section
+ * table (see state.c) can be read and checked without the key.  Saves
+ * from before that were scrambled as one stream, and ones from before
+ * that a field at a time, each field starting over at the top of the
+ * keystream; reading one of those unscrambles it the same way.
+ */
+static TLOCAL char *sv_buf;		/* The saved game */
+static TLOCAL size_t sv_len;		/* How much of it there is */
+static TLOCAL size_t sv_size;		/* How big sv_buf is */
+static TLOCAL size_t sv_pos;		/* Where the next read comes from */
+static TLOCAL bool sv_loaded;		/* It was read in, not written */
+static TLOCAL bool sv_byfield;		/* Old save, scrambled by field */
+static TLOCAL bool sv_bysection;	/* Scrambled a section at a time */
+
+/*
+ * save_room:
+ *	Make sure there is room for more in the buffer
+ */
+static bool
+save_room(size_t size)
+{
+    char *nbuf;
+    size_t nsize;
+
+    if (sv_len + size <= sv_size)
+	return TRUE;
+    for (nsize = (sv_size == 0 ? BUFSIZ : sv_size); nsize < sv_len + size; nsize *= 2)
+	continue;
+    if ((nbuf = realloc(sv_buf, nsize)) == NULL)
+	return FALSE;
+    sv_buf = nbuf;
+    sv_size = nsize;
+    return TRUE;
+}
+
+/*
+ * save_free:
+ *	Let go of the buffer
+ */
+static void
+save_free()
+{
+    free(sv_buf);
+    sv_buf = NULL;
+    sv_len = sv_size = sv_pos = 0;
+    sv_loaded = FALSE;
+}
+
+/*
+ * savewrite:
+ *	Add to the saved game being put together
+ */
+size_t
+savewrite(char *start, size_t size)
+{
+    if (!save_room(size))
+	return 0;
+    memcpy(&sv_buf[sv_len], start, size);
+    sv_len += size;
+    return size;
+}
+
+/*
+ * savecrypt:
+ *	Scramble or unscramble part of the saved game in place, from the
+ *	top of the keystream.  A save that was scrambled as one stream
+ *	was unscrambled whole when it was read in, so it is left be.
  */
 void
-rd_score(SCORE *top_ten)
+savecrypt(size_t pos, size_t size)
 {
-    unsigned int i;
+    struct cipher c;
 
-	if (scoreboard == NULL)
-		return;
+    if ((sv_loaded && !sv_bysection) || pos > sv_len || size > sv_len - pos)
+	return;
+    cipher_init(&c);
+    cipher_run(&c, &sv_buf[pos], size);
+}
+
+/*
+ * saveflush:
+ *	Write the saved game out in one go
+ */
+bool
+saveflush(FILE *outf)
+{
+    bool ok;
+
+    ok = (bool) (fflush(outf) == 0
+		 && fwrite(sv_buf, 1, sv_len, outf) == sv_len
+		 && fflush(outf) == 0);
+    save_free();
+    return ok;
+}
 
-	rewind(scoreboard); 
+/*
+ * saveload:
+ *	Read in a whole saved game and unscramble it, after checking
+ *	which version wrote it.  Returns FALSE if it's not one we know.
+ */
+bool
+saveload(FILE *inf)
+{
+    struct cipher c;
+    size_t n, vlen;
+    char buf[MAXSTR];
 
-	for(i = 0; i < numscores; i++)
+    save_free();
+    sv_loaded = TRUE;
+    do
     {
-        encread(top_ten[i].sc_name, MAXSTR, scoreboard);
-        encread(scoreline, 100, scoreboard);
-        sscanf(scoreline, " %u %d %u %hu %d %x \n",
-            &top_ten[i].sc_uid, &top_ten[i].sc_score,
-            &top_ten[i].sc_flags, &top_ten[i].sc_monster,
-            &top_ten[i].sc_level, &top_ten[i].sc_time);
+	if (!save_room(BUFSIZ))
+	    return FALSE;
+	n = fread(&sv_buf[sv_len], 1, sv_size - sv_len, inf);
+	sv_len += n;
+    } while (n > 0);
+    /*
+     * The version is always scrambled on its own
+     */
+    vlen = max(strlen(version), strlen(oversion)) + 1;
+    if (vlen > sv_len || vlen > sizeof buf)
+	return FALSE;
+    memcpy(buf, sv_buf, vlen);
+    cipher_init(&c);
+    cipher_run(&c, buf, vlen);
+    buf[vlen - 1] = '\0';
+    sv_byfield = sv_bysection = FALSE;
+    if (strcmp(buf, version) == 0)
+    {
+	sv_pos = strlen(version) + 1;
+	if (sv_len - sv_pos >= SV_SIZELINE + 4
+	  && memcmp(&sv_buf[sv_pos + SV_SIZELINE], SV_SECTIONS, 4) == 0)
+	{
+	    sv_bysection = TRUE;
+	    savecrypt(sv_pos, SV_SIZELINE);
+	}
+	else
+	{
+	    cipher_init(&c);
+	    cipher_run(&c, &sv_buf[sv_pos], sv_len - sv_pos);
+	}
+    }
+    else if (strcmp(buf, oversion) == 0)
+    {
+	sv_pos = strlen(oversion) + 1;
+	sv_byfield = TRUE;
     }
+    else
+	return FALSE;
+    return TRUE;
+}
 
-	rewind(scoreboard); 
+/*
+ * saveread:
+ *	Take the next part of the saved game that was read in
+ */
+size_t
+saveread(char *start, size_t size)
+{
+    struct cipher c;
+
+    if (size > sv_len - sv_pos)
+	size = sv_len - sv_pos;
+    memcpy(start, &sv_buf[sv_pos], size);
+    sv_pos += size;
+    if (sv_byfield)
+    {
+	cipher_init(&c);
+	cipher_run(&c, start, size);
+    }
+    return size;
 }
 
 /*
- * write_scrore
- *	Read in the score file
+ * savepos:
+ *	How far into the saved game we are: the end of what has been
+ *	written, or where the next read comes from
+ */
+size_t
+savepos()
+{
+    return (sv_loaded ? sv_pos : sv_len);
+}
+
+/*
+ * saveseek:
+ *	Move to somewhere else in a saved game that was read in
  */
 void
-wr_score(SCORE *top_ten)
+saveseek(size_t pos)
 {
-    unsigned int i;
+    sv_pos = (pos < sv_len ? pos : sv_len);
+}
 
-	if (scoreboard == NULL)
-		return;
+/*
+ * saveat:
+ *	Get at the saved game in place, or NULL if there isn't that much
+ *	of it
+ */
+char *
+saveat(size_t pos, size_t size)
+{
+    if (pos > sv_len || size > sv_len - pos)
+	return NULL;
+    return &sv_buf[pos];
+}
 
-	rewind(scoreboard);
+static TLOCAL int sc_infile;		/* Records the file had when read */
+static TLOCAL bool sc_legacy;		/* It was in the old text format */
+
+/*
+ * sc_put32, sc_get32:
+ *	Numbers in the score file, least significant byte first
+ */
+static void
+sc_put32(unsigned char *p, unsigned int v)
+{
+    p[0] = (unsigned char) (v & 0xff);
+    p[1] = (unsigned char) ((v >> 8) & 0xff);
+    p[2] = (unsigned char) ((v >> 16) & 0xff);
+    p[3] = (unsigned char) ((v >> 24) & 0xff);
+}
+
+static unsigned int
+sc_get32(unsigned char *p)
+{
+    return (unsigned int) p[0] | ((unsigned int) p[1] << 8)
+	| ((unsigned int) p[2] << 16) | ((unsigned int) p[3] << 24);
+}
+
+/*
+ * sc_pack, sc_unpack:
+ *	Turn a score into a record and back
+ */
+static void
+sc_pack(unsigned char *p, SCORE *scp)
+{
+    memset(p, 0, SC_RECSIZE);
+    sc_put32(p, scp->sc_uid);
+    sc_put32(p + 4, (unsigned int) scp->sc_score);
+    sc_put32(p + 8, scp->sc_flags);
+    sc_put32(p + 12, (unsigned int) scp->sc_level);
+    sc_put32(p + 16, scp->sc_time);
+    p[20] = (unsigned char) (scp->sc_monster & 0xff);
+    p[21] = (unsigned char) (scp->sc_monster >> 8);
+    strncpy((char *) p + 24, scp->sc_name, SC_NAMELEN - 1);
+}
+
+static void
+sc_unpack(unsigned char *p, SCORE *scp)
+{
+    scp->sc_uid = sc_get32(p);
+    scp->sc_score = (int) sc_get32(p + 4);
+    scp->sc_flags = sc_get32(p + 8);
+    scp->sc_level = (int) sc_get32(p + 12);
+    scp->sc_time = sc_get32(p + 16);
+    scp->sc_monster = (unsigned short) (p[20] | (p[21] << 8));
+    memcpy(scp->sc_name, p + 24, SC_NAMELEN);
+    scp->sc_name[SC_NAMELEN - 1] = '\0';
+}
 
-    for(i = 0; i < numscores; i++)
+/*
+ * rd_legacy:
+ *	Read a score file in the old format, a scrambled name and a line
+ *	of text for each score, keeping the scores that are really there
+ */
+static int
+rd_legacy(SCORE *list, int n)
+{
+    static char name[MAXSTR], scoreline[100];
+    int i, got;
+
+    got = 0;
+    for (i = 0; i < n; i++)
     {
-          memset(scoreline,0,100);
-          encwrite(top_ten[i].sc_name, MAXSTR, scoreboard);
-          sprintf(scoreline, " %u %d %u %hu %d %x \n",
-              top_ten[i].sc_uid, top_ten[i].sc_score,
-              top_ten[i].sc_flags, top_ten[i].sc_monster,
-              top_ten[i].sc_level, top_ten[i].sc_time);
-          encwrite(scoreline,100,scoreboard);
+	encread(name, MAXSTR, scoreboard);
+	encread(scoreline, 100, scoreboard);
+	if (sscanf(scoreline, " %u %d %u %hu %d %x \n",
+	    &list[got].sc_uid, &list[got].sc_score,
+	    &list[got].sc_flags, &list[got].sc_monster,
+	    &list[got].sc_level, &list[got].sc_time) != 6
+	  || list[got].sc_score <= 0 || list[got].sc_flags > 3)
+	    continue;
+	name[MAXSTR - 1] = '\0';
+	strncpy(list[got].sc_name, name, SC_NAMELEN - 1);
+	list[got].sc_name[SC_NAMELEN - 1] = '\0';
+	got++;
     }
+    return got;
+}
 
-	rewind(scoreboard); 
+/*
+ * rd_score:
+ *	Read in the score file.  The scores go in a list made for them,
+ *	with room for one more, and how many there are is returned.
+ */
+int
+rd_score(SCORE **listp)
+{
+    unsigned char head[SC_HEAD], *buf;
+    SCORE *list;
+    long size;
+    int i, n;
+
+    *listp = NULL;
+    sc_infile = 0;
+    sc_legacy = FALSE;
+    if (scoreboard == NULL)
+	return 0;
+
+    fseek(scoreboard, 0L, SEEK_END);
+    size = ftell(scoreboard);
+    rewind(scoreboard);
+    if (size >= SC_HEAD && fread(head, SC_HEAD, 1, scoreboard) == 1
+      && sc_get32(head) == SC_MAGIC && sc_get32(head + 4) == SC_VERSION
+      && sc_get32(head + 12) == SC_RECSIZE)
+    {
+	n = (int) sc_get32(head + 8);
+	if (n < 0 || n > (size - SC_HEAD) / SC_RECSIZE)
+	    n = (int) ((size - SC_HEAD) / SC_RECSIZE);
+	if ((list = malloc((n + 1) * sizeof *list)) == NULL)
+	    return 0;
+	if (n > 0)
+	{
+	    if ((buf = malloc((size_t) n * SC_RECSIZE)) == NULL)
+	    {
+		free(list);
+		return 0;
+	    }
+	    n = (int) fread(buf, SC_RECSIZE, n, scoreboard);
+	    for (i = 0; i < n; i++)
+		sc_unpack(buf + (size_t) i * SC_RECSIZE, &list[i]);
+	    free(buf);
+	}
+	sc_infile = n;
+    }
+    else
+    {
+	/*
+	 * Anything else there is from before; it gets rewritten in
+	 * the new format the first time a score is posted
+	 */
+	n = (int) (size / (MAXSTR + 100));
+	if ((list = malloc((n + 1) * sizeof *list)) == NULL)
+	    return 0;
+	rewind(scoreboard);
+	n = rd_legacy(list, n);
+	sc_legacy = (size > 0);
+    }
+    rewind(scoreboard);
+    *listp = list;
+    return n;
+}
+
+/*
+ * wr_score:
+ *	Update the score file to hold the n scores in the list.  Only
+ *	the record in the given slot has changed, unless slot is -1;
+ *	anything past the end of the list is cut off.
+ */
+void
+wr_score(SCORE *list, int n, int slot)
+{
+    unsigned char head[SC_HEAD], *buf;
+    int i, first, last;
+
+    if (scoreboard == NULL)
+	return;
+
+    if (sc_legacy || slot < 0)
+    {
+	first = 0;
+	last = n - 1;
+    }
+    else
+	first = last = slot;
+    if (first < n && last >= first)
+    {
+	if ((buf = malloc((size_t) (last - first + 1) * SC_RECSIZE)) == NULL)
+	    return;
+	for (i = first; i <= last; i++)
+	    sc_pack(buf + (size_t) (i - first) * SC_RECSIZE, &list[i]);
+	fseek(scoreboard, SC_HEAD + (long) first * SC_RECSIZE, SEEK_SET);
+	fwrite(buf, SC_RECSIZE, last - first + 1, scoreboard);
+	free(buf);
+    }
+    /*
+     * The header goes last, so the count never takes in a record
+     * that isn't there yet
+     */
+    sc_put32(head, SC_MAGIC);
+    sc_put32(head + 4, SC_VERSION);
+    sc_put32(head + 8, (unsigned int) n);
+    sc_put32(head + 12, SC_RECSIZE);
+    fseek(scoreboard, 0L, SEEK_SET);
+    fwrite(head, SC_HEAD, 1, scoreboard);
+    fflush(scoreboard);
+    if (sc_legacy || n < sc_infile)
+	md_truncate(fileno(scoreboard), SC_HEAD + (long) n * SC_RECSIZE);
+    sc_infile = n;
+    sc_legacy = FALSE;
+    rewind(scoreboard);
 }
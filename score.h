@@ -10,17 +10,55 @@
  * See the file LICENSE.TXT for full copyright and licensing information.
  */
 
+/*
+ * The score file is a header and then one fixed-size record for each
+ * score, every number stored least significant byte first, so other
+ * programs can map it and read it as it is:
+ *
+ *	header:	SC_MAGIC, SC_VERSION, number of records, SC_RECSIZE
+ *	record:	uid, score, flags, level, time, monster (2 bytes),
+ *		2 bytes of padding, name (SC_NAMELEN, NUL padded)
+ *
+ * The records are in no particular order.  A new score goes in a
+ * record of its own, or over the one it replaces, and only that
+ * record and the header are written.
+ */
+#define SC_MAGIC	0x43534752	/* "RGSC" */
+#define SC_VERSION	1
+#define SC_HEAD		16
+#define SC_NAMELEN	80
+#define SC_RECSIZE	(24 + SC_NAMELEN)
+
 struct sc_ent {
     unsigned int sc_uid;
     int sc_score;
     unsigned int sc_flags;
     unsigned short sc_monster;
-    char sc_name[MAXSTR];
+    char sc_name[SC_NAMELEN];
     int sc_level;
     unsigned int sc_time;
 };
 
 typedef struct sc_ent SCORE;
 
-void	rd_score(SCORE *top_ten);
-void	wr_score(SCORE *top_ten);
+/*
+ * Every game that ends is also added to the game log, a line of
+ * name=value fields for each, and to its binary twin, a record of
+ * XL_RECSIZE bytes for each, least significant byte first:
+ *
+ *	 0  XL_MAGIC		 4  XL_RECSIZE (2), XL_VERSION (2)
+ *	 8  dungeon number	12  uid
+ *	16  time it ended	20  score
+ *	24  gold		28  turns
+ *	32  flags, killer, deepest level, last level (1 each)
+ *	36  hit points, max hit points (2 each)
+ *	40  strength, max strength, experience level, armor (1 each)
+ *	44  experience		48  name (XL_NAMELEN, NUL padded)
+ */
+#define XL_MAGIC	0x4c584752	/* "RGXL" */
+#define XL_VERSION	1
+#define XL_NAMELEN	16
+#define XL_RECSIZE	(48 + XL_NAMELEN)
+
+int	rd_score(SCORE **listp);
+void	wr_score(SCORE *list, int n, int slot);
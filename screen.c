@@ -0,0 +1,528 @@
+/*
+ * The shadow screen.  Everything the game draws on stdscr is kept
+ * here as well, a byte to a cell, so when it wants to know what is
+ * showing somewhere it looks here instead of asking curses.  Curses
+ * is only ever told what to draw.
+ *
+ * The shadow also remembers which part of each line has changed
+ * since the last frame, and decides when a frame goes out: once a
+ * turn for certain, and in between only for animation that fits in
+ * the frame budget.  While running, turns are left out as well when
+ * the terminal can't keep up.  Each frame that goes out is passed on
+ * to the watch file and the recording.
+ *
+ * Rogue: Exploring the Dungeons of Doom
+ * Copyright (C) 1980-1983, 1985, 1999 Michael Toy, Ken Arnold and Glenn Wichman
+ * All rights reserved.
+ *
+ * See the file LICENSE.TXT for full copyright and licensing information.
+ */
+
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <curses.h>
+#include "rogue.h"
+
+/*
+ * Here they are curses' own
+ */
+#undef waddch
+#undef waddstr
+#undef wclrtoeol
+#undef mvwprintw
+#undef wgetnstr
+
+#define SO		0x80		/* Standout bit in a shadow cell */
+
+#define shadow		(game->g_shadow)
+#define sh_lines	(game->g_sh_lines)
+#define sh_cols	(game->g_sh_cols)
+#define sh_so		(game->g_sh_so)
+#define sh_first	(game->g_sh_first)
+#define sh_last		(game->g_sh_last)
+#define anim_start	(game->g_anim_start)
+#define frame_ms	(game->g_frame_ms)
+#define frame_skip	(game->g_frame_skip)
+#define frame_left	(game->g_frame_left)
+
+/*
+ * How backed up output has to get before running shows fewer frames
+ */
+#define OUTQ_HIGH	512		/* Bytes the terminal hasn't taken */
+#define OUTQ_LOW	64
+#define SLOW_FRAME	30		/* Milliseconds for one refresh */
+#define MAXSKIP		63
+
+/*
+ * sh_init:
+ *	Make the shadow the size of stdscr, all blank
+ */
+static void
+sh_init()
+{
+    sh_lines = getmaxy(stdscr);
+    sh_cols = getmaxx(stdscr);
+    shadow = malloc(sh_lines * sh_cols + 1);
+    sh_first = malloc((sh_lines + 1) * sizeof *sh_first);
+    sh_last = malloc((sh_lines + 1) * sizeof *sh_last);
+    if (shadow == NULL || sh_first == NULL || sh_last == NULL)
+    {
+	free_screen();
+	return;
+    }
+    memset(shadow, ' ', sh_lines * sh_cols);
+    sh_clean();
+}
+
+/*
+ * sh_mark:
+ *	Note that part of a line has changed
+ */
+static void
+sh_mark(int y, int x1, int x2)
+{
+    if (x1 < sh_first[y])
+	sh_first[y] = x1;
+    if (x2 > sh_last[y])
+	sh_last[y] = x2;
+}
+
+/*
+ * sh_cell:
+ *	Find a place on the screen in the shadow, or NULL if it is off
+ *	the screen
+ */
+static unsigned char *
+sh_cell(int y, int x)
+{
+    if (shadow == NULL)
+	sh_init();
+    if (y < 0 || y >= sh_lines || x < 0 || x >= sh_cols)
+	return NULL;
+    return &shadow[y * sh_cols + x];
+}
+
+/*
+ * sh_blank:
+ *	Blank the shadow from a place to the end of its line
+ */
+static void
+sh_blank(int y, int x)
+{
+    unsigned char *cp, *ep;
+
+    if ((cp = sh_cell(y, x)) == NULL)
+	return;
+    for (ep = cp + sh_cols - x; cp < ep; cp++)
+	if (*cp != ' ')
+	{
+	    sh_mark(y, x, sh_cols - 1);
+	    memset(cp, ' ', ep - cp);
+	    break;
+	}
+}
+
+/*
+ * sh_put:
+ *	Do to the shadow what waddch() does to stdscr, moving the
+ *	cursor along the same way
+ */
+static void
+sh_put(int *yp, int *xp, chtype c)
+{
+    unsigned char *cp, nc;
+    const char *sp;
+    int ch;
+
+    ch = (int) (c & A_CHARTEXT);
+    switch (ch)
+    {
+	case '\n':
+	    sh_blank(*yp, *xp);
+	    if (*yp + 1 < sh_lines)
+		(*yp)++;
+	    *xp = 0;
+	when '\r':
+	    *xp = 0;
+	when '\b':
+	    if (*xp > 0)
+		(*xp)--;
+	when '\t':
+	    do
+		sh_put(yp, xp, ' ');
+	    while (*xp % 8 != 0);
+	otherwise:
+	    if (ch < ' ' || ch >= 0x7f)
+	    {
+		for (sp = unctrl(c); *sp != '\0'; sp++)
+		    sh_put(yp, xp, (chtype) (unsigned char) *sp);
+		break;
+	    }
+	    nc = (unsigned char) (ch | ((sh_so || (c & A_STANDOUT)) ? SO : 0));
+	    if ((cp = sh_cell(*yp, *xp)) != NULL && *cp != nc)
+	    {
+		*cp = nc;
+		sh_mark(*yp, *xp, *xp);
+	    }
+	    if (++*xp >= sh_cols)
+	    {
+		*xp = 0;
+		if (*yp + 1 < sh_lines)
+		    (*yp)++;
+	    }
+    }
+}
+
+/*
+ * sh_addch:
+ *	Draw a character where the cursor is
+ */
+int
+sh_addch(chtype c)
+{
+    int y, x;
+
+    getyx(stdscr, y, x);
+    sh_put(&y, &x, c);
+    return waddch(stdscr, c);
+}
+
+/*
+ * sh_addstr:
+ *	Draw a string where the cursor is
+ */
+int
+sh_addstr(const char *s)
+{
+    const char *sp;
+    int y, x;
+
+    getyx(stdscr, y, x);
+    for (sp = s; *sp != '\0'; sp++)
+	sh_put(&y, &x, (chtype) (unsigned char) *sp);
+    return waddstr(stdscr, s);
+}
+
+/*
+ * sh_printw:
+ *	Draw formatted output where the cursor is
+ */
+int
+sh_printw(const char *fmt, ...)
+{
+    char buf[4*MAXSTR];
+    va_list args;
+
+    va_start(args, fmt);
+    vsnprintf(buf, sizeof buf, fmt, args);
+    va_end(args);
+    return sh_addstr(buf);
+}
+
+int
+sh_mvprintw(int y, int x, const char *fmt, ...)
+{
+    char buf[4*MAXSTR];
+    va_list args;
+
+    if (wmove(stdscr, y, x) == ERR)
+	return ERR;
+    va_start(args, fmt);
+    vsnprintf(buf, sizeof buf, fmt, args);
+    va_end(args);
+    return sh_addstr(buf);
+}
+
+/*
+ * sh_clrtoeol:
+ *	Blank out the rest of the line the cursor is on
+ */
+int
+sh_clrtoeol()
+{
+    int y, x;
+
+    getyx(stdscr, y, x);
+    sh_blank(y, x);
+    return wclrtoeol(stdscr);
+}
+
+/*
+ * sh_clear:
+ *	Blank the whole screen
+ */
+int
+sh_clear()
+{
+    int y;
+
+    if (shadow == NULL)
+	sh_init();
+    memset(shadow, ' ', sh_lines * sh_cols);
+    for (y = 0; y < sh_lines; y++)
+	sh_mark(y, 0, sh_cols - 1);
+    return wclear(stdscr);
+}
+
+/*
+ * sh_standout:
+ *	Start or stop drawing in standout
+ */
+int
+sh_standout(bool on)
+{
+    sh_so = on;
+    return (on ? wstandout(stdscr) : wstandend(stdscr));
+}
+
+/*
+ * sh_waddch, sh_waddstr, sh_wclrtoeol, sh_mvwprintw:
+ *	The same for any window, drawing through the shadow when it is
+ *	stdscr
+ */
+int
+sh_waddch(WINDOW *win, chtype c)
+{
+    if (win == stdscr)
+	return sh_addch(c);
+    return waddch(win, c);
+}
+
+int
+sh_waddstr(WINDOW *win, const char *s)
+{
+    if (win == stdscr)
+	return sh_addstr(s);
+    return waddstr(win, s);
+}
+
+int
+sh_wclrtoeol(WINDOW *win)
+{
+    if (win == stdscr)
+	return sh_clrtoeol();
+    return wclrtoeol(win);
+}
+
+int
+sh_mvwprintw(WINDOW *win, int y, int x, const char *fmt, ...)
+{
+    char buf[4*MAXSTR];
+    va_list args;
+
+    if (wmove(win, y, x) == ERR)
+	return ERR;
+    va_start(args, fmt);
+    vsnprintf(buf, sizeof buf, fmt, args);
+    va_end(args);
+    return sh_waddstr(win, buf);
+}
+
+/*
+ * sh_wrefresh:
+ *	Show a window while waiting for her to type.  For stdscr that
+ *	is a whole frame, so the watchers and the recording see the
+ *	prompt and what she has typed so far.
+ */
+void
+sh_wrefresh(WINDOW *win)
+{
+    if (win == stdscr)
+	end_frame();
+    else
+	wrefresh(win);
+}
+
+/*
+ * sh_wgetnstr:
+ *	Read a line.  The game runs with echo off, so nothing typed goes
+ *	on the screen and the shadow stays as it is; what is showing is
+ *	sent first, so it gets seen.
+ */
+int
+sh_wgetnstr(WINDOW *win, char *str, int n)
+{
+    sh_wrefresh(win);
+    return wgetnstr(win, str, n);
+}
+
+/*
+ * sh_inch:
+ *	What is showing where the cursor is
+ */
+chtype
+sh_inch()
+{
+    unsigned char *cp;
+    int y, x;
+
+    getyx(stdscr, y, x);
+    if ((cp = sh_cell(y, x)) == NULL)
+	return (chtype) ' ';
+    return (chtype) (*cp & ~SO) | ((*cp & SO) ? A_STANDOUT : 0);
+}
+
+/*
+ * sh_at:
+ *	Get at the shadow itself, for saving the screen all at once.
+ *	The size of it is left in *linesp and *colsp.
+ */
+unsigned char *
+sh_at(int *linesp, int *colsp)
+{
+    if (shadow == NULL)
+	sh_init();
+    *linesp = sh_lines;
+    *colsp = sh_cols;
+    return shadow;
+}
+
+/*
+ * sh_dirty:
+ *	Has a line changed since the last frame?  If so, say from
+ *	where to where.
+ */
+bool
+sh_dirty(int y, int *firstp, int *lastp)
+{
+    if (shadow == NULL || y < 0 || y >= sh_lines || sh_first[y] > sh_last[y])
+	return FALSE;
+    *firstp = sh_first[y];
+    *lastp = sh_last[y];
+    return TRUE;
+}
+
+/*
+ * sh_clean:
+ *	Start a new frame with nothing changed
+ */
+void
+sh_clean()
+{
+    int y;
+
+    for (y = 0; y < sh_lines; y++)
+    {
+	sh_first[y] = sh_cols;
+	sh_last[y] = -1;
+    }
+}
+
+/*
+ * end_frame:
+ *	Send the turn's frame, everything that has changed during it in
+ *	one refresh
+ */
+void
+end_frame()
+{
+#ifdef ROGUE_SIM
+    refresh();
+#else
+    long start;
+
+    start = md_millis();
+    refresh();
+    frame_ms = (int) (md_millis() - start);
+#endif
+    watch_frame();
+    rec_frame();
+    if (shadow != NULL)
+	sh_clean();
+    anim_start = 0;
+}
+
+/*
+ * skip_frame:
+ *	Should this step of a run or a counted command go undrawn?  The
+ *	more the terminal falls behind, the more steps are left out.
+ *	The run's last step always gets drawn, since the caller only
+ *	asks while it is still going.
+ */
+bool
+skip_frame()
+{
+#ifdef ROGUE_SIM
+    return FALSE;
+#else
+    int pend;
+
+    if (frame_left > 0)
+    {
+	frame_left--;
+	return TRUE;
+    }
+    pend = md_outqueue();
+    if (pend > OUTQ_HIGH || frame_ms > SLOW_FRAME)
+    {
+	frame_skip = frame_skip * 2 + 1;
+	if (frame_skip > MAXSKIP)
+	    frame_skip = MAXSKIP;
+    }
+    else if (pend <= OUTQ_LOW)
+	frame_skip /= 2;
+    if (pend > OUTQ_HIGH)
+	return TRUE;
+    frame_left = frame_skip;
+    return FALSE;
+#endif
+}
+
+/*
+ * anim_frame:
+ *	Show a step of some animation now, unless there is nothing new
+ *	to show or the turn's animation has already had its frame budget.
+ *	A frame left out here goes out with the rest of the turn.
+ */
+void
+anim_frame()
+{
+    long now;
+    int y;
+
+    for (y = 0; y < sh_lines; y++)
+	if (sh_first[y] <= sh_last[y])
+	    break;
+    if (y >= sh_lines)
+	return;
+#ifdef ROGUE_SIM
+    now = 1;				/* Nobody is watching, so no clock */
+#else
+    now = md_millis();
+#endif
+    if (anim_start == 0)
+	anim_start = now;
+    else if (frame_time > 0 && now - anim_start > frame_time)
+	return;
+    refresh();
+    rec_frame();
+    sh_clean();
+}
+
+/*
+ * anim_turn:
+ *	A new turn has started, so its animation gets a fresh budget,
+ *	whether or not the last turn's frame went out
+ */
+void
+anim_turn()
+{
+    anim_start = 0;
+}
+
+/*
+ * free_screen:
+ *	Give back the shadow
+ */
+void
+free_screen()
+{
+    free(shadow);
+    free(sh_first);
+    free(sh_last);
+    shadow = NULL;
+    sh_first = sh_last = NULL;
+    sh_lines = sh_cols = 0;
+}
@@ -23,14 +23,14 @@ void
 read_scroll()
 {
     THING *obj;
-    PLACE *pp;
+    int pp;
     int y, x;
     char ch;
     int i;
     bool discardit = FALSE;
     struct room *cur_room;
     THING *orig_obj;
-    static coord mp;
+    static TLOCAL coord mp;
 
     obj = get_item("read", SCROLL);
     if (obj == NULL)
@@ -164,6 +164,7 @@ read_scroll()
 	     */
 	    scr_info[S_MAP].oi_know = TRUE;
 	    msg("oh, now this scroll has a map on it");
+	    game->g_flow_ok = FALSE;
 	    /*
 	     * take all the things we want to keep hidden out of the window
 	     */
@@ -171,7 +172,7 @@ read_scroll()
 		for (x = 0; x < NUMCOLS; x++)
 		{
 		    pp = INDEX(y, x);
-		    switch (ch = pp->p_ch)
+		    switch (ch = places.p_ch[pp])
 		    {
 			case DOOR:
 			case STAIRS:
@@ -179,49 +180,49 @@ read_scroll()
 
 			case '-':
 			case '|':
-			    if (!(pp->p_flags & F_REAL))
+			    if (!(places.p_flags[pp] & F_REAL))
 			    {
-				ch = pp->p_ch = DOOR;
-				pp->p_flags |= F_REAL;
+				set_chat(y, x, ch = DOOR);
+				places.p_flags[pp] |= F_REAL;
 			    }
 			    break;
 
 			case ' ':
-			    if (pp->p_flags & F_REAL)
+			    if (places.p_flags[pp] & F_REAL)
 				goto def;
-			    pp->p_flags |= F_REAL;
-			    ch = pp->p_ch = PASSAGE;
+			    places.p_flags[pp] |= F_REAL;
+			    set_chat(y, x, ch = PASSAGE);
 			    /* FALLTHROUGH */
 
 			case PASSAGE:
 pass:
-			    if (!(pp->p_flags & F_REAL))
-				pp->p_ch = PASSAGE;
-			    pp->p_flags |= (F_SEEN|F_REAL);
+			    if (!(places.p_flags[pp] & F_REAL))
+				set_chat(y, x, PASSAGE);
+			    places.p_flags[pp] |= (F_SEEN|F_REAL);
 			    ch = PASSAGE;
 			    break;
 
 			case FLOOR:
-			    if (pp->p_flags & F_REAL)
+			    if (places.p_flags[pp] & F_REAL)
 				ch = ' ';
 			    else
 			    {
 				ch = TRAP;
-				pp->p_ch = TRAP;
-				pp->p_flags |= (F_SEEN|F_REAL);
+				set_chat(y, x, TRAP);
+				places.p_flags[pp] |= (F_SEEN|F_REAL);
 			    }
 			    break;
 
 			default:
 def:
-			    if (pp->p_flags & F_PASS)
+			    if (places.p_flags[pp] & F_PASS)
 				goto pass;
 			    ch = ' ';
 			    break;
 		    }
 		    if (ch != ' ')
 		    {
-			if ((obj = pp->p_monst) != NULL)
+			if ((obj = mslot[places.p_mon[pp]]) != NULL)
 			    obj->t_oldch = ch;
 			if (obj == NULL || !on(player, SEEMONST))
 			    mvaddch(y, x, ch);
@@ -0,0 +1,671 @@
+/*
+ * Headless simulator: plays games with no terminal, taking the
+ * keystrokes from a feed instead of the keyboard, as many at a time
+ * as there are processors
+ *
+ * Rogue: Exploring the Dungeons of Doom
+ * Copyright (C) 1980-1983, 1985, 1999 Michael Toy, Ken Arnold and Glenn Wichman
+ * All rights reserved.
+ *
+ * See the file LICENSE.TXT for full copyright and licensing information.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <curses.h>
+#include "rogue.h"
+
+/*
+ * sim_play:
+ *	Play the current game from dungeon number dungeon until it is
+ *	over, with feed supplying the keystrokes.  Returns how it ended;
+ *	the details are left in game->g_result.
+ */
+int
+sim_play(int dungeon, int (*feed)(void *arg), void *arg)
+{
+    struct sim_result *rp;
+    int how;
+
+    rp = &game->g_result;
+    game->g_feed = feed;
+    game->g_feed_arg = arg;
+    if ((how = setjmp(game->g_sim_done)) == 0)
+    {
+	initscr();
+	if (hw == NULL)
+	    hw = newwin(LINES, COLS, 0, 0);
+	dnum = dungeon;
+	rng_seed(&game->g_rng, dnum);
+	start_game();
+	oldpos = hero;
+	oldrp = roomin(&hero);
+	while (playing)
+	    command();
+	how = SIM_EXIT;
+    }
+    rp->sr_end = how;
+    rp->sr_level = level;
+    rp->sr_max_level = max_level;
+    rp->sr_purse = purse;
+    rp->sr_turns = turns;
+    return how;
+}
+
+/*
+ * sim_end:
+ *	The game is over, one way or another; go back to sim_play()
+ */
+void
+sim_end(int how)
+{
+    longjmp(game->g_sim_done, how);
+}
+
+/*
+ * md_readchar:
+ *	Get the next keystroke from the feed.  When it runs dry the game
+ *	is over.
+ */
+int
+md_readchar()
+{
+    int ch;
+
+    if ((ch = (*game->g_feed)(game->g_feed_arg)) < 0)
+	sim_end(SIM_NOINPUT);
+    return ch & 0x7F;
+}
+
+/*
+ * The stand-alone simulator plays a range of dungeons, either all
+ * with the same scripted keystrokes or with a simple built-in bot,
+ * spread over a pool of threads.
+ */
+
+/*
+ * Scripted keystrokes: every game starts again from the top
+ */
+struct keys {
+    char *k_buf;
+    size_t k_len, k_pos;
+};
+
+static int
+key_feed(void *arg)
+{
+    struct keys *kp = (struct keys *) arg;
+
+    if (kp->k_pos >= kp->k_len)
+	return -1;
+    return (unsigned char) kp->k_buf[kp->k_pos++];
+}
+
+/*
+ * The bot: heads for the stairs when it has seen them, eats when it
+ * is hungry, fights whatever is next to it and otherwise wanders and
+ * searches.  It has its own random numbers so that it never disturbs
+ * the ones the game is using.
+ */
+struct bot {
+    unsigned int b_rand;		/* xorshift state */
+    long b_keys, b_limit;		/* Keys sent, and how many allowed */
+    char b_pend[4];			/* Rest of a multi-key command */
+    char *b_next;
+};
+
+static char bot_dirs[] = "ykuh.lbjn";	/* by (dy + 1) * 3 + (dx + 1) */
+
+static unsigned int
+bot_rand(struct bot *bp, unsigned int range)
+{
+    unsigned int x = bp->b_rand;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    bp->b_rand = x;
+    return x % range;
+}
+
+static int
+bot_feed(void *arg)
+{
+    struct bot *bp = (struct bot *) arg;
+    THING *obj;
+    int x, y, dx, dy;
+
+    if (bp->b_keys++ >= bp->b_limit)
+	return -1;
+    if (*bp->b_next != '\0')
+	return *bp->b_next++;
+    if (chat(hero.y, hero.x) == STAIRS)
+	return '>';
+    if (hungry_state > 1)
+	for (obj = pack; obj != NULL; obj = next(obj))
+	    if (obj->o_type == FOOD)
+	    {
+		bp->b_pend[0] = obj->o_packch;
+		bp->b_pend[1] = '\0';
+		bp->b_next = bp->b_pend;
+		return 'e';
+	    }
+    for (y = hero.y - 1; y <= hero.y + 1; y++)
+	for (x = hero.x - 1; x <= hero.x + 1; x++)
+	    if (y >= 1 && y < NUMLINES - 1 && x >= 0 && x < NUMCOLS
+	      && moat(y, x) != NULL && diag_ok(&hero, &moat(y, x)->t_pos))
+		return bot_dirs[(y - hero.y + 1) * 3 + (x - hero.x + 1)];
+    if (CCHAR(mvinch(stairs.y, stairs.x)) == STAIRS && bot_rand(bp, 3) != 0)
+    {
+	dy = sign(stairs.y - hero.y);
+	dx = sign(stairs.x - hero.x);
+	return bot_dirs[(dy + 1) * 3 + (dx + 1)];
+    }
+    if (bot_rand(bp, 6) == 0)
+	return 's';
+    do
+	x = bot_rand(bp, 9);
+    until (x != 4);
+    return toupper(bot_dirs[x]);
+}
+
+/*
+ * What one game came to
+ */
+struct run {
+    int r_dungeon;
+    struct sim_result r_res;
+    char r_cause[MAXSTR];		/* How it ended, in words */
+    int r_hash_bad;			/* Turns the state hash was wrong */
+    int r_hash_when;			/* First of them */
+};
+
+/*
+ * How every game is to be played
+ */
+static struct keys Keys;		/* Scripted keystrokes, or... */
+static bool Use_bot = FALSE;		/* ...the bot */
+static long Bot_limit = 20000;		/* Keys the bot may send */
+static char *Opts = NULL;		/* Options for each game */
+static bool Sim_wait = FALSE;		/* Feed answers --More-- */
+static int Engine = RNG_CLASSIC;	/* Random number engine */
+static bool Hash_check = FALSE;		/* Check the state hash every turn */
+static struct run *Runs;		/* Results, by dungeon */
+
+/*
+ * set_cause:
+ *	Put how the current game ended in words
+ */
+static void
+set_cause(struct run *rp)
+{
+    static char *reason[] = {
+	"killed by",
+	"quit",
+	"a total winner",
+	"killed with the Amulet by"
+    };
+    struct sim_result *sp;
+
+    sp = &game->g_result;
+    rp->r_res = *sp;
+    if (sp->sr_end == SIM_NOINPUT)
+	strcpy(rp->r_cause, "out of keystrokes");
+    else if (sp->sr_end != SIM_DONE || sp->sr_flags < 0 || sp->sr_flags > 3)
+	strcpy(rp->r_cause, "left the game");
+    else if (sp->sr_flags == 0 || sp->sr_flags == 3)
+	sprintf(rp->r_cause, "%s %s", reason[sp->sr_flags],
+	    killname(sp->sr_monst, TRUE));
+    else
+	strcpy(rp->r_cause, reason[sp->sr_flags]);
+}
+
+/*
+ * run_game:
+ *	Play one dungeon from the range and record how it went
+ */
+static void
+run_game(struct run *rp)
+{
+    struct keys keys;
+    struct bot bot;
+    char opts[MAXSTR];
+
+    if ((game = new_game()) == NULL)
+    {
+	strcpy(rp->r_cause, "no memory");
+	return;
+    }
+    strcpy(whoami, "simulator");
+    tombstone = FALSE;
+    if (Opts != NULL)
+    {
+	strucpy(opts, Opts, (int) strlen(Opts));
+	parse_opts(opts);
+    }
+    game->g_sim_wait = Sim_wait;
+    game->g_rng.r_engine = Engine;
+    game->g_hash_check = Hash_check;
+    if (Use_bot)
+    {
+	bot.b_rand = (unsigned int) rp->r_dungeon * 2654435761u | 1;
+	bot.b_keys = 0;
+	bot.b_limit = Bot_limit;
+	bot.b_pend[0] = '\0';
+	bot.b_next = bot.b_pend;
+	sim_play(rp->r_dungeon, bot_feed, &bot);
+    }
+    else
+    {
+	keys = Keys;
+	sim_play(rp->r_dungeon, key_feed, &keys);
+    }
+    set_cause(rp);
+    rp->r_hash_bad = game->g_hash_bad;
+    rp->r_hash_when = game->g_hash_when;
+    free_game(game);
+    game = NULL;
+}
+
+/*
+ * run_replay:
+ *	Play a recorded game back as fast as it will go, checking it
+ *	against the recording all the way.  Returns FALSE if it didn't
+ *	play out the same.
+ */
+static bool
+run_replay(char *file)
+{
+    struct run run;
+    bool same;
+
+    if ((game = new_game()) == NULL)
+    {
+	fprintf(stderr, "%s: out of memory\n", file);
+	return FALSE;
+    }
+    strcpy(whoami, "simulator");
+    tombstone = FALSE;
+    if (!replay_load(file, &run.r_dungeon))
+    {
+	fprintf(stderr, "%s: not a keystroke recording\n", file);
+	free_game(game);
+	game = NULL;
+	return FALSE;
+    }
+    sim_play(run.r_dungeon, replay_feed, NULL);
+    same = replay_end();
+    set_cause(&run);
+    printf("%s: dungeon %d, %ld keystrokes, %d checksums matched\n", file,
+	run.r_dungeon, game->g_rp_keys, game->g_rp_sums);
+    if (same)
+	printf("%s: level %d, turn %d, gold %d, %s\n", file,
+	    run.r_res.sr_level, run.r_res.sr_turns, run.r_res.sr_purse,
+	    run.r_cause);
+    else
+	printf("%s: went astray at turn %d\n", file, run.r_res.sr_turns);
+    free_game(game);
+    game = NULL;
+    return same;
+}
+
+/*
+ * The thread pool.  Each worker starts with an even share of the
+ * games and runs them from the bottom up; when it runs out it steals
+ * the top half of whatever another worker has left.
+ */
+struct worker {
+    pthread_t w_thread;
+    pthread_mutex_t w_lock;
+    int w_lo, w_hi;			/* Games left to run: [w_lo, w_hi) */
+};
+
+static struct worker *Workers;
+static int Nworkers;
+
+/*
+ * steal:
+ *	Take half of the remaining games from some other worker
+ */
+static bool
+steal(struct worker *wp)
+{
+    struct worker *vp;
+    int i, n;
+
+    for (i = 1; i < Nworkers; i++)
+    {
+	vp = &Workers[(wp - Workers + i) % Nworkers];
+	pthread_mutex_lock(&vp->w_lock);
+	if ((n = (vp->w_hi - vp->w_lo + 1) / 2) > 0)
+	{
+	    vp->w_hi -= n;
+	    pthread_mutex_lock(&wp->w_lock);
+	    wp->w_lo = vp->w_hi;
+	    wp->w_hi = vp->w_hi + n;
+	    pthread_mutex_unlock(&wp->w_lock);
+	    pthread_mutex_unlock(&vp->w_lock);
+	    return TRUE;
+	}
+	pthread_mutex_unlock(&vp->w_lock);
+    }
+    return FALSE;
+}
+
+static void *
+worker(void *arg)
+{
+    struct worker *wp = (struct worker *) arg;
+    int i;
+
+    for (;;)
+    {
+	pthread_mutex_lock(&wp->w_lock);
+	i = (wp->w_lo < wp->w_hi ? wp->w_lo++ : -1);
+	pthread_mutex_unlock(&wp->w_lock);
+	if (i >= 0)
+	    run_game(&Runs[i]);
+	else if (!steal(wp))
+	    break;
+    }
+    return NULL;
+}
+
+/*
+ * The save/restore benchmark: one level crowded with monsters and
+ * objects, saved and restored over and over
+ */
+static int
+no_feed(void *arg)
+{
+    NOOP(arg);
+    return -1;
+}
+
+static int
+list_len(THING *tp)
+{
+    int n;
+
+    for (n = 0; tp != NULL; tp = next(tp))
+	n++;
+    return n;
+}
+
+/*
+ * crowd:
+ *	Put up to n monsters and n objects on the level, with half the
+ *	monsters after one of the objects
+ */
+static void
+crowd(int n)
+{
+    THING *tp, *obj;
+    coord cp;
+    int i;
+
+    for (i = 0; i < n; i++)
+    {
+	if (!find_floor(NULL, &cp, 500, FALSE))
+	    break;
+	obj = new_thing();
+	obj->o_pos = cp;
+	attach(lvl_obj, obj);
+	set_chat(cp.y, cp.x, (char) obj->o_type);
+    }
+    for (i = 0, obj = lvl_obj; i < n; i++)
+    {
+	if (!find_floor(NULL, &cp, 500, TRUE))
+	    break;
+	tp = new_item();
+	new_monster(tp, randmonster(FALSE), &cp);
+	if (i % 2 == 0 && obj != NULL)
+	{
+	    tp->t_dest = &obj->o_pos;
+	    obj = next(obj);
+	}
+    }
+}
+
+/*
+ * bench_save:
+ *	Time saving and restoring a crowded level rounds times.  Each
+ *	restored game has to hash the same as the one that was saved.
+ */
+static void
+bench_save(int dungeon, int rounds, int n)
+{
+    struct game *g, *rg;
+    FILE *fp;
+    clock_t tsave, trest, t;
+    long size;
+    char buf[80];
+    hash_t want;
+    int r;
+
+    if ((g = game = new_game()) == NULL || (fp = tmpfile()) == NULL)
+    {
+	fprintf(stderr, "bench: out of memory\n");
+	exit(1);
+    }
+    strcpy(whoami, "simulator");
+    strcpy(file_name, "bench.save");
+    sim_play(dungeon, no_feed, NULL);
+    crowd(n);
+    want = hash_full();
+    printf("#monsters\tobjects\tbytes\tsave(us)\trestore(us)\n");
+    tsave = trest = 0;
+    size = 0;
+    for (r = 0; r < rounds; r++)
+    {
+	rewind(fp);
+	t = clock();
+	if (!save_write(fp))
+	{
+	    fprintf(stderr, "bench: save failed\n");
+	    exit(1);
+	}
+	tsave += clock() - t;
+	size = ftell(fp);
+	rewind(fp);
+	t = clock();
+	if ((rg = game = new_game()) == NULL)
+	    break;
+	if (!saveload(fp) || saveread(buf, 80) != 80 || rs_restore_file(fp) != 0)
+	{
+	    fprintf(stderr, "bench: restore failed\n");
+	    exit(1);
+	}
+	trest += clock() - t;
+	if (hash_full() != want)
+	{
+	    fprintf(stderr, "bench: restored game differs from the saved one\n");
+	    exit(1);
+	}
+	free_game(rg);
+	game = g;
+    }
+    printf("%d\t%d\t%ld\t%.1f\t%.1f\n", list_len(mlist), list_len(lvl_obj),
+	size, tsave * 1e6 / CLOCKS_PER_SEC / rounds,
+	trest * 1e6 / CLOCKS_PER_SEC / rounds);
+    fclose(fp);
+    free_game(g);
+    game = NULL;
+}
+
+/*
+ * read_keys:
+ *	Slurp a whole file of keystrokes
+ */
+static bool
+read_keys(char *file, struct keys *kp)
+{
+    FILE *fp;
+    size_t n, size;
+
+    if (strcmp(file, "-") == 0)
+	fp = stdin;
+    else if ((fp = fopen(file, "rb")) == NULL)
+	return FALSE;
+    size = 4096;
+    kp->k_buf = malloc(size);
+    kp->k_len = 0;
+    while (kp->k_buf != NULL
+	&& (n = fread(&kp->k_buf[kp->k_len], 1, size - kp->k_len, fp)) > 0)
+    {
+	kp->k_len += n;
+	if (kp->k_len == size)
+	    kp->k_buf = realloc(kp->k_buf, size *= 2);
+    }
+    if (fp != stdin)
+	fclose(fp);
+    return (kp->k_buf != NULL);
+}
+
+/*
+ * main:
+ *	rogue-sim [-s seed] [-n games] [-j threads] [-r engine]
+ *		  [-o options] [-w] [-b [-m maxkeys] | -k keys | -f keyfile]
+ *	rogue-sim [-s seed] -S rounds [-c crowd]
+ *	rogue-sim --replay file ...
+ */
+int
+main(int argc, char **argv)
+{
+    int dungeon, ngames, i, per, rounds, ncrowd, astray, bad;
+    struct run *rp;
+    struct sim_result *sp;
+
+    dungeon = (int) time(NULL) + md_getpid();
+    ngames = 1;
+    rounds = 0;
+    ncrowd = 500;
+    Nworkers = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    Keys.k_buf = "";
+    Keys.k_len = Keys.k_pos = 0;
+    if (argc > 2 && strcmp(argv[1], "--replay") == 0)
+    {
+	astray = 0;
+	for (i = 2; i < argc; i++)
+	    if (!run_replay(argv[i]))
+		astray = 1;
+	return astray;
+    }
+    for (i = 1; i < argc; i++)
+    {
+	if (strcmp(argv[i], "-w") == 0)
+	    Sim_wait = TRUE;
+	else if (strcmp(argv[i], "-b") == 0)
+	    Use_bot = TRUE;
+	else if (strcmp(argv[i], "-H") == 0)
+	    Hash_check = TRUE;
+	else if (i + 1 >= argc)
+	    break;
+	else if (strcmp(argv[i], "-s") == 0)
+	    dungeon = atoi(argv[++i]);
+	else if (strcmp(argv[i], "-n") == 0)
+	    ngames = atoi(argv[++i]);
+	else if (strcmp(argv[i], "-j") == 0)
+	    Nworkers = atoi(argv[++i]);
+	else if (strcmp(argv[i], "-S") == 0)
+	    rounds = atoi(argv[++i]);
+	else if (strcmp(argv[i], "-c") == 0)
+	    ncrowd = atoi(argv[++i]);
+	else if (strcmp(argv[i], "-m") == 0)
+	    Bot_limit = atol(argv[++i]);
+	else if (strcmp(argv[i], "-r") == 0)
+	{
+	    if ((Engine = rng_find(argv[++i])) < 0)
+		break;
+	}
+	else if (strcmp(argv[i], "-o") == 0)
+	    Opts = argv[++i];
+	else if (strcmp(argv[i], "-k") == 0)
+	{
+	    Keys.k_buf = argv[++i];
+	    Keys.k_len = strlen(Keys.k_buf);
+	}
+	else if (strcmp(argv[i], "-f") == 0)
+	{
+	    if (!read_keys(argv[++i], &Keys))
+	    {
+		perror(argv[i]);
+		exit(1);
+	    }
+	}
+	else
+	    break;
+    }
+    if (i < argc || ngames < 1)
+    {
+	fprintf(stderr, "usage: %s [-s seed] [-n games] [-j threads] [-r classic|fast]\n", argv[0]);
+	fprintf(stderr, "\t\t[-o options] [-w] [-H] [-b [-m maxkeys] | -k keys | -f keyfile]\n");
+	fprintf(stderr, "       %s [-s seed] -S rounds [-c crowd]\n", argv[0]);
+	fprintf(stderr, "       %s --replay file ...\n", argv[0]);
+	exit(1);
+    }
+    if (rounds > 0)
+    {
+	bench_save(dungeon, rounds, ncrowd);
+	return 0;
+    }
+    if (Nworkers < 1)
+	Nworkers = 1;
+    if (Nworkers > ngames)
+	Nworkers = ngames;
+
+    Runs = calloc(ngames, sizeof *Runs);
+    Workers = calloc(Nworkers, sizeof *Workers);
+    if (Runs == NULL || Workers == NULL)
+    {
+	fprintf(stderr, "%s: out of memory\n", argv[0]);
+	exit(1);
+    }
+    for (i = 0; i < ngames; i++)
+	Runs[i].r_dungeon = dungeon + i;
+    per = ngames / Nworkers;
+    for (i = 0; i < Nworkers; i++)
+    {
+	pthread_mutex_init(&Workers[i].w_lock, NULL);
+	Workers[i].w_lo = i * per;
+	Workers[i].w_hi = (i == Nworkers - 1 ? ngames : (i + 1) * per);
+    }
+    for (i = 0; i < Nworkers; i++)
+	if (pthread_create(&Workers[i].w_thread, NULL, worker, &Workers[i]) != 0)
+	{
+	    perror("pthread_create");
+	    exit(1);
+	}
+    for (i = 0; i < Nworkers; i++)
+	pthread_join(Workers[i].w_thread, NULL);
+
+    /*
+     * Print them in dungeon order, so the output is the same however
+     * many threads there were
+     */
+    printf("#dungeon\tlevel\tdeepest\tturns\tgold\tamount\tflags\tmonst\tcause\n");
+    for (rp = Runs; rp < &Runs[ngames]; rp++)
+    {
+	sp = &rp->r_res;
+	printf("%d\t%d\t%d\t%d\t%d\t%d\t%d\t%s\t%s\n", rp->r_dungeon,
+	    sp->sr_level, sp->sr_max_level, sp->sr_turns, sp->sr_purse,
+	    sp->sr_amount, sp->sr_flags,
+	    sp->sr_monst == 0 ? "-" : unctrl(sp->sr_monst), rp->r_cause);
+    }
+    /*
+     * The state hash should never be found wrong
+     */
+    bad = 0;
+    for (rp = Runs; rp < &Runs[ngames]; rp++)
+	if (rp->r_hash_bad > 0)
+	{
+	    fprintf(stderr, "dungeon %d: state hash wrong on %d turns, first turn %d\n",
+		rp->r_dungeon, rp->r_hash_bad, rp->r_hash_when);
+	    bad = 1;
+	}
+    return bad;
+}
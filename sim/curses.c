@@ -0,0 +1,324 @@
+/*
+ * Null screen package for the headless simulator build.  See curses.h.
+ *
+ * Rogue: Exploring the Dungeons of Doom
+ * Copyright (C) 1980-1983, 1985, 1999 Michael Toy, Ken Arnold and Glenn Wichman
+ * All rights reserved.
+ *
+ * See the file LICENSE.TXT for full copyright and licensing information.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include "curses.h"
+
+#define SIM_LINES	24
+#define SIM_COLS	80
+
+int LINES = SIM_LINES;
+int COLS = SIM_COLS;
+int ESCDELAY = 0;
+TLOCAL WINDOW *stdscr = NULL;
+TLOCAL WINDOW *curscr = NULL;
+
+static TLOCAL bool in_curses = FALSE;
+
+/*
+ * initscr:
+ *	Set up the screen windows.  A second call just hands back the
+ *	existing stdscr.
+ */
+WINDOW *
+initscr(void)
+{
+    if (stdscr == NULL)
+    {
+	stdscr = newwin(LINES, COLS, 0, 0);
+	curscr = newwin(LINES, COLS, 0, 0);
+    }
+    in_curses = TRUE;
+    return stdscr;
+}
+
+int
+endwin(void)
+{
+    in_curses = FALSE;
+    return OK;
+}
+
+bool
+isendwin(void)
+{
+    return !in_curses;
+}
+
+/*
+ * newwin:
+ *	Make a window, blank and with the cursor in the corner
+ */
+WINDOW *
+newwin(int nlines, int ncols, int begy, int begx)
+{
+    WINDOW *win;
+
+    if (nlines <= 0)
+	nlines = LINES - begy;
+    if (ncols <= 0)
+	ncols = COLS - begx;
+    if ((win = (WINDOW *) malloc(sizeof *win)) == NULL)
+	return NULL;
+    win->_maxy = (short) nlines;
+    win->_maxx = (short) ncols;
+    win->_begy = (short) begy;
+    win->_begx = (short) begx;
+    werase(win);
+    return win;
+}
+
+/*
+ * subwin:
+ *	Nothing ever reads a subwindow back through its parent, so it
+ *	can just be a window of its own
+ */
+WINDOW *
+subwin(WINDOW *orig, int nlines, int ncols, int begy, int begx)
+{
+    (void) orig;
+    return newwin(nlines, ncols, begy, begx);
+}
+
+int
+delwin(WINDOW *win)
+{
+    if (win == NULL)
+	return ERR;
+    if (win == stdscr)
+	stdscr = NULL;
+    else if (win == curscr)
+	curscr = NULL;
+    free(win);
+    return OK;
+}
+
+int
+wmove(WINDOW *win, int y, int x)
+{
+    if (y < 0 || y >= win->_maxy || x < 0 || x >= win->_maxx)
+	return ERR;
+    win->_cury = (short) y;
+    win->_curx = (short) x;
+    return OK;
+}
+
+/*
+ * waddch:
+ *	Move the cursor on past a character the way curses does,
+ *	including its treatment of newlines, tabs and other control
+ *	characters
+ */
+int
+waddch(WINDOW *win, chtype ch)
+{
+    int c;
+    char *sp;
+
+    c = (int) (ch & A_CHARTEXT);
+    if (c == '\n')
+    {
+	if (win->_cury + 1 >= win->_maxy)
+	    return ERR;
+	win->_cury++;
+	win->_curx = 0;
+	return OK;
+    }
+    if (c == '\t')
+    {
+	do
+	    if (waddch(win, ' ') == ERR)
+		return ERR;
+	while (win->_curx % 8 != 0);
+	return OK;
+    }
+    if (c == '\b')
+    {
+	if (win->_curx > 0)
+	    win->_curx--;
+	return OK;
+    }
+    if (c < ' ' || c == 0177)
+    {
+	for (sp = unctrl((chtype) c); *sp; sp++)
+	    if (waddch(win, (ch & ~A_CHARTEXT) | (unsigned char) *sp) == ERR)
+		return ERR;
+	return OK;
+    }
+    if (++win->_curx >= win->_maxx)
+    {
+	if (win->_cury + 1 >= win->_maxy)
+	{
+	    win->_curx = win->_maxx - 1;
+	    return ERR;
+	}
+	win->_curx = 0;
+	win->_cury++;
+    }
+    return OK;
+}
+
+int
+waddstr(WINDOW *win, const char *str)
+{
+    while (*str)
+	if (waddch(win, (unsigned char) *str++) == ERR)
+	    return ERR;
+    return OK;
+}
+
+static int
+vwprintw(WINDOW *win, const char *fmt, va_list args)
+{
+    char buf[1024];
+
+    vsnprintf(buf, sizeof buf, fmt, args);
+    return waddstr(win, buf);
+}
+
+int
+wprintw(WINDOW *win, const char *fmt, ...)
+{
+    va_list args;
+    int r;
+
+    va_start(args, fmt);
+    r = vwprintw(win, fmt, args);
+    va_end(args);
+    return r;
+}
+
+int
+mvwprintw(WINDOW *win, int y, int x, const char *fmt, ...)
+{
+    va_list args;
+    int r;
+
+    if (wmove(win, y, x) == ERR)
+	return ERR;
+    va_start(args, fmt);
+    r = vwprintw(win, fmt, args);
+    va_end(args);
+    return r;
+}
+
+int
+printw(const char *fmt, ...)
+{
+    va_list args;
+    int r;
+
+    va_start(args, fmt);
+    r = vwprintw(stdscr, fmt, args);
+    va_end(args);
+    return r;
+}
+
+int
+mvprintw(int y, int x, const char *fmt, ...)
+{
+    va_list args;
+    int r;
+
+    if (wmove(stdscr, y, x) == ERR)
+	return ERR;
+    va_start(args, fmt);
+    r = vwprintw(stdscr, fmt, args);
+    va_end(args);
+    return r;
+}
+
+/*
+ * winch:
+ *	Nothing is kept, so the screen always looks blank; the game asks
+ *	the shadow instead
+ */
+chtype
+winch(WINDOW *win)
+{
+    (void) win;
+    return (chtype) ' ';
+}
+
+int
+wclrtoeol(WINDOW *win)
+{
+    (void) win;
+    return OK;
+}
+
+int
+werase(WINDOW *win)
+{
+    win->_cury = win->_curx = 0;
+    return OK;
+}
+
+int
+mvwin(WINDOW *win, int y, int x)
+{
+    win->_begy = (short) y;
+    win->_begx = (short) x;
+    return OK;
+}
+
+/*
+ * wgetnstr, wgetch:
+ *	There is no keyboard; the game gets its keys through md_readchar()
+ */
+int
+wgetnstr(WINDOW *win, char *str, int n)
+{
+    (void) win;
+    if (n > 0)
+	*str = '\0';
+    return OK;
+}
+
+int
+wgetch(WINDOW *win)
+{
+    (void) win;
+    return ERR;
+}
+
+char *
+unctrl(chtype c)
+{
+    static TLOCAL char buf[3];
+
+    c &= A_CHARTEXT;
+    if (c < ' ' || c == 0177)
+    {
+	buf[0] = '^';
+	buf[1] = (char) (c == 0177 ? '?' : c + '@');
+	buf[2] = '\0';
+    }
+    else
+    {
+	buf[0] = (char) c;
+	buf[1] = '\0';
+    }
+    return buf;
+}
+
+int
+erasechar(void)
+{
+    return '\b';
+}
+
+int
+killchar(void)
+{
+    return ('U' & 037);
+}
@@ -0,0 +1,153 @@
+/*
+ * Null screen package for the headless simulator build
+ *
+ * This stands in for <curses.h> when rogue is built as rogue-sim.  The
+ * game reads what is on the screen from its own shadow (screen.c), so
+ * a window here is no more than a size and a cursor that moves the way
+ * it would under real curses.  Nothing is ever drawn or kept.
+ *
+ * Rogue: Exploring the Dungeons of Doom
+ * Copyright (C) 1980-1983, 1985, 1999 Michael Toy, Ken Arnold and Glenn Wichman
+ * All rights reserved.
+ *
+ * See the file LICENSE.TXT for full copyright and licensing information.
+ */
+
+#ifndef ROGUE_SIM_CURSES_H
+#define ROGUE_SIM_CURSES_H
+
+#include <stdio.h>
+
+/*
+ * Storage that belongs to each simulator thread, for rogue.h's
+ * scratch and the screens here: C11's keyword where the compiler has
+ * it, GCC's otherwise
+ */
+#ifndef TLOCAL
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_THREADS__)
+#define TLOCAL	_Thread_local
+#else
+#define TLOCAL	__thread
+#endif
+#endif
+
+#ifndef __cplusplus
+#ifndef bool
+typedef unsigned char bool;
+#endif
+#endif
+
+#ifndef TRUE
+#define TRUE	1
+#endif
+#ifndef FALSE
+#define FALSE	0
+#endif
+
+#define ERR	(-1)
+#define OK	0
+
+typedef unsigned int chtype;
+
+#define A_CHARTEXT	0x000000ffU
+#define A_STANDOUT	0x00010000U
+
+#define KEY_DOWN	0402
+#define KEY_UP		0403
+#define KEY_LEFT	0404
+#define KEY_RIGHT	0405
+#define KEY_HOME	0406
+#define KEY_BACKSPACE	0407
+#define KEY_NPAGE	0522
+#define KEY_PPAGE	0523
+#define KEY_A1		0534
+#define KEY_A3		0535
+#define KEY_B2		0536
+#define KEY_C1		0537
+#define KEY_C3		0540
+#define KEY_END		0550
+
+typedef struct _win_st {
+    short _cury, _curx;			/* Cursor position */
+    short _maxy, _maxx;			/* Size of the window */
+    short _begy, _begx;			/* Where it is on the screen */
+} WINDOW;
+
+extern int	LINES, COLS, ESCDELAY;
+extern TLOCAL WINDOW	*stdscr, *curscr;	/* one screen per simulator thread */
+
+WINDOW	*initscr(void);
+int	endwin(void);
+bool	isendwin(void);
+WINDOW	*newwin(int nlines, int ncols, int begy, int begx);
+WINDOW	*subwin(WINDOW *orig, int nlines, int ncols, int begy, int begx);
+int	delwin(WINDOW *win);
+int	wmove(WINDOW *win, int y, int x);
+int	waddch(WINDOW *win, chtype ch);
+int	waddstr(WINDOW *win, const char *str);
+int	wprintw(WINDOW *win, const char *fmt, ...);
+int	mvwprintw(WINDOW *win, int y, int x, const char *fmt, ...);
+int	printw(const char *fmt, ...);
+int	mvprintw(int y, int x, const char *fmt, ...);
+chtype	winch(WINDOW *win);
+int	wclrtoeol(WINDOW *win);
+int	werase(WINDOW *win);
+int	mvwin(WINDOW *win, int y, int x);
+int	wgetnstr(WINDOW *win, char *str, int n);
+int	wgetch(WINDOW *win);
+char	*unctrl(chtype c);
+int	erasechar(void);
+int	killchar(void);
+
+#define getyx(w,y,x)	((y) = (w)->_cury, (x) = (w)->_curx)
+#define getmaxy(w)	((w)->_maxy)
+#define getmaxx(w)	((w)->_maxx)
+
+#define wclear(w)	werase(w)
+#define mvwaddch(w,y,x,c)	(wmove(w,y,x) == ERR ? ERR : waddch(w,c))
+#define mvwaddstr(w,y,x,s)	(wmove(w,y,x) == ERR ? ERR : waddstr(w,s))
+#define mvwinch(w,y,x)	(wmove(w,y,x) == ERR ? (chtype) ERR : winch(w))
+
+#define move(y,x)	wmove(stdscr,y,x)
+#define addch(c)	waddch(stdscr,c)
+#define addstr(s)	waddstr(stdscr,s)
+#define mvaddch(y,x,c)	mvwaddch(stdscr,y,x,c)
+#define mvaddstr(y,x,s)	mvwaddstr(stdscr,y,x,s)
+#define inch()		winch(stdscr)
+#define mvinch(y,x)	mvwinch(stdscr,y,x)
+#define clrtoeol()	wclrtoeol(stdscr)
+#define clear()		werase(stdscr)
+#define erase()		werase(stdscr)
+#define standout()	wstandout(stdscr)
+#define standend()	wstandend(stdscr)
+#define refresh()	wrefresh(stdscr)
+#define getch()		wgetch(stdscr)
+
+/*
+ * Everything that only affects what the terminal shows does nothing.
+ * These are functions rather than bare OKs so that calling one as a
+ * statement doesn't leave an unused value behind.
+ */
+#define SIM_NOOP(name, args)	static inline int name args { return OK; }
+
+SIM_NOOP(wstandout, (WINDOW *w))
+SIM_NOOP(wstandend, (WINDOW *w))
+SIM_NOOP(wrefresh, (WINDOW *w))
+SIM_NOOP(touchwin, (WINDOW *w))
+SIM_NOOP(clearok, (WINDOW *w, bool b))
+SIM_NOOP(leaveok, (WINDOW *w, bool b))
+SIM_NOOP(idlok, (WINDOW *w, bool b))
+SIM_NOOP(keypad, (WINDOW *w, bool b))
+SIM_NOOP(raw, (void))
+SIM_NOOP(noraw, (void))
+SIM_NOOP(cbreak, (void))
+SIM_NOOP(nocbreak, (void))
+SIM_NOOP(echo, (void))
+SIM_NOOP(noecho, (void))
+SIM_NOOP(halfdelay, (int t))
+SIM_NOOP(flushinp, (void))
+SIM_NOOP(mvcur, (int oy, int ox, int ny, int nx))
+
+#define baudrate()	38400
+
+#endif /* ROGUE_SIM_CURSES_H */
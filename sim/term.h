@@ -0,0 +1,3 @@
+/*
+ * The headless simulator build has no terminal capabilities
+ */
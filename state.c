@@ -62,13 +62,14 @@
 #define RSID_CTYPES       0XABCD0015
 #define RSID_COORDLIST    0XABCD0016
 #define RSID_ROOMS        0XABCD0017
+#define RSID_RNG          0XABCD0018
 
 #define READSTAT (format_error || read_error )
 #define WRITESTAT (write_error)
 
-static int read_error   = FALSE;
-static int write_error  = FALSE;
-static int format_error = FALSE;
+static TLOCAL int read_error   = FALSE;
+static TLOCAL int write_error  = FALSE;
+static TLOCAL int format_error = FALSE;
 static int endian = 0x01020304;
 #define  big_endian ( *((char *)&endian) == 0x01 )
 
@@ -78,7 +79,7 @@ rs_write(FILE *savef, void *ptr, size_t size)
     if (write_error)
         return(WRITESTAT);
 
-    if (encwrite(ptr, size, savef) != size)
+    if (savewrite(ptr, size) != size)
         write_error = 1;
 
     return(WRITESTAT);
@@ -90,7 +91,7 @@ rs_read(FILE *inf, void *ptr, size_t size)
     if (read_error || format_error)
         return(READSTAT);
 
-    if (encread(ptr, size, inf) != size)
+    if (saveread(ptr, size) != size)
         read_error = 1;
        
     return(READSTAT);
@@ -168,19 +169,19 @@ rs_read_char(FILE *inf, char *c)
 }
 
 int
-rs_write_chars(FILE *savef, char *c, int count)
+rs_write_chars(FILE *savef, char *c, int cnt)
 {
     if (write_error)
         return(WRITESTAT);
 
-    rs_write_int(savef, count);
-    rs_write(savef, c, count);
+    rs_write_int(savef, cnt);
+    rs_write(savef, c, cnt);
 
     return(WRITESTAT);
 }
 
 int
-rs_read_chars(FILE *inf, char *i, int count)
+rs_read_chars(FILE *inf, char *i, int cnt)
 {
     int value = 0;
     
@@ -189,25 +190,25 @@ rs_read_chars(FILE *inf, char *i, int count)
 
     rs_read_int(inf, &value);
     
-    if (value != count)
+    if (value != cnt)
         format_error = TRUE;
 
-    rs_read(inf, i, count);
+    rs_read(inf, i, cnt);
     
     return(READSTAT);
 }
 
 int
-rs_write_ints(FILE *savef, int *c, int count)
+rs_write_ints(FILE *savef, int *c, int cnt)
 {
     int n = 0;
 
     if (write_error)
         return(WRITESTAT);
 
-    rs_write_int(savef, count);
+    rs_write_int(savef, cnt);
 
-    for(n = 0; n < count; n++)
+    for(n = 0; n < cnt; n++)
         if( rs_write_int(savef,c[n]) != 0)
             break;
 
@@ -215,7 +216,7 @@ rs_write_ints(FILE *savef, int *c, int count)
 }
 
 int
-rs_read_ints(FILE *inf, int *i, int count)
+rs_read_ints(FILE *inf, int *i, int cnt)
 {
     int n, value;
     
@@ -224,10 +225,10 @@ rs_read_ints(FILE *inf, int *i, int count)
 
     rs_read_int(inf,&value);
 
-    if (value != count)
+    if (value != cnt)
         format_error = TRUE;
 
-    for(n = 0; n < count; n++)
+    for(n = 0; n < cnt; n++)
         if (rs_read_int(inf, &i[n]) != 0)
             break;
     
@@ -263,16 +264,16 @@ rs_read_boolean(FILE *inf, bool *i)
 }
 
 int
-rs_write_booleans(FILE *savef, bool *c, int count)
+rs_write_booleans(FILE *savef, bool *c, int cnt)
 {
     int n = 0;
 
     if (write_error)
         return(WRITESTAT);
 
-    rs_write_int(savef, count);
+    rs_write_int(savef, cnt);
 
-    for(n = 0; n < count; n++)
+    for(n = 0; n < cnt; n++)
         if (rs_write_boolean(savef, c[n]) != 0)
             break;
 
@@ -280,7 +281,7 @@ rs_write_booleans(FILE *savef, bool *c, int count)
 }
 
 int
-rs_read_booleans(FILE *inf, bool *i, int count)
+rs_read_booleans(FILE *inf, bool *i, int cnt)
 {
     int n = 0, value = 0;
     
@@ -289,10 +290,10 @@ rs_read_booleans(FILE *inf, bool *i, int count)
 
     rs_read_int(inf,&value);
 
-    if (value != count)
+    if (value != cnt)
         format_error = TRUE;
 
-    for(n = 0; n < count; n++)
+    for(n = 0; n < cnt; n++)
         if (rs_read_boolean(inf, &i[n]) != 0)
             break;
     
@@ -345,16 +346,16 @@ rs_read_short(FILE *inf, short *i)
 } 
 
 int
-rs_write_shorts(FILE *savef, short *c, int count)
+rs_write_shorts(FILE *savef, short *c, int cnt)
 {
     int n = 0;
 
     if (write_error)
         return(WRITESTAT);
 
-    rs_write_int(savef, count);
+    rs_write_int(savef, cnt);
 
-    for(n = 0; n < count; n++)
+    for(n = 0; n < cnt; n++)
         if (rs_write_short(savef, c[n]) != 0)
             break; 
 
@@ -362,7 +363,7 @@ rs_write_shorts(FILE *savef, short *c, int count)
 }
 
 int
-rs_read_shorts(FILE *inf, short *i, int count)
+rs_read_shorts(FILE *inf, short *i, int cnt)
 {
     int n = 0, value = 0;
 
@@ -371,7 +372,7 @@ rs_read_shorts(FILE *inf, short *i, int count)
 
     rs_read_int(inf,&value);
 
-    if (value != count)
+    if (value != cnt)
         format_error = TRUE;
 
     for(n = 0; n < value; n++)
@@ -568,16 +569,16 @@ rs_read_new_string(FILE *inf, char **s)
 }
 
 int
-rs_write_strings(FILE *savef, char *s[], int count)
+rs_write_strings(FILE *savef, char *s[], int cnt)
 {
     int n = 0;
 
     if (write_error)
         return(WRITESTAT);
 
-    rs_write_int(savef, count);
+    rs_write_int(savef, cnt);
 
-    for(n = 0; n < count; n++)
+    for(n = 0; n < cnt; n++)
         if (rs_write_string(savef, s[n]) != 0)
             break;
     
@@ -585,7 +586,7 @@ rs_write_strings(FILE *savef, char *s[], int count)
 }
 
 int
-rs_read_strings(FILE *inf, char **s, int count, int max)
+rs_read_strings(FILE *inf, char **s, int cnt, int max)
 {
     int n     = 0;
     int value = 0;
@@ -595,10 +596,10 @@ rs_read_strings(FILE *inf, char **s, int count, int max)
 
     rs_read_int(inf, &value);
 
-    if (value != count)
+    if (value != cnt)
         format_error = TRUE;
 
-    for(n = 0; n < count; n++)
+    for(n = 0; n < cnt; n++)
         if (rs_read_string(inf, s[n], max) != 0)
             break;
     
@@ -606,7 +607,7 @@ rs_read_strings(FILE *inf, char **s, int count, int max)
 }
 
 int
-rs_read_new_strings(FILE *inf, char **s, int count)
+rs_read_new_strings(FILE *inf, char **s, int cnt)
 {
     int n     = 0;
     int value = 0;
@@ -616,10 +617,10 @@ rs_read_new_strings(FILE *inf, char **s, int count)
 
     rs_read_int(inf, &value);
 
-    if (value != count)
+    if (value != cnt)
         format_error = TRUE;
 
-    for(n = 0; n < count; n++)
+    for(n = 0; n < cnt; n++)
         if (rs_read_new_string(inf, &s[n]) != 0)
             break;
     
@@ -715,29 +716,6 @@ rs_read_coord(FILE *inf, coord *c)
     return(READSTAT);
 }
 
-int
-rs_write_window(FILE *savef, WINDOW *win)
-{
-    int row,col,height,width;
-
-    if (write_error)
-        return(WRITESTAT);
-
-    width  = getmaxx(win);
-    height = getmaxy(win);
-
-    rs_write_marker(savef,RSID_WINDOW);
-    rs_write_int(savef,height);
-    rs_write_int(savef,width);
-
-    for(row=0;row<height;row++)
-        for(col=0;col<width;col++)
-            if (rs_write_int(savef, mvwinch(win,row,col)) != 0)
-                return(WRITESTAT);
-
-    return(WRITESTAT);
-}
-
 int
 rs_read_window(FILE *inf, WINDOW *win)
 {
@@ -761,7 +739,7 @@ rs_read_window(FILE *inf, WINDOW *win)
                 return(READSTAT);
 
             if ((row < height) && (col < width))
-                mvwaddch(win,row,col,value);
+                mvaddch(row,col,value);
         }
         
     return(READSTAT);
@@ -769,39 +747,165 @@ rs_read_window(FILE *inf, WINDOW *win)
 
 /******************************************************************************/
 
+/*
+ * References into the lists are saved as where they are on the list.
+ * Rather than walk the list for every one, each list is turned into
+ * an array, and a hash from pointer back to index, the first time it
+ * is needed in a save or restore.  Nothing is freed during a pass, so
+ * the tables stay good until it ends, when they are thrown away.
+ */
+#define NLISTS	4
+
+struct rs_list {
+    THING *l_head;			/* First on the list */
+    int l_by;				/* What it is hashed by: RS_BY* */
+    int l_n;				/* How many are on it */
+    THING **l_item;			/* The list, by index */
+    void **l_key;			/* Hash keys: THINGs or positions */
+    int *l_val;				/* Index for each key */
+    int l_size;				/* Size of the hash, a power of 2 */
+};
+
+#define RS_BYTHING	0		/* The THING itself */
+#define RS_BYMONPOS	1		/* A monster's t_pos */
+#define RS_BYOBJPOS	2		/* An object's o_pos */
+
+static TLOCAL struct rs_list rs_lists[NLISTS];
+static TLOCAL int rs_nlists;
+
+int list_size(THING *l);
+
+#define RS_HASH(p, size)	((int) (((size_t) (p) >> 4) * 2654435761u) & ((size) - 1))
+
+/*
+ * rs_forget_lists:
+ *	Throw away the tables for all the lists
+ */
+void
+rs_forget_lists()
+{
+    struct rs_list *lp;
+
+    for (lp = rs_lists; lp < &rs_lists[NLISTS]; lp++)
+    {
+        free(lp->l_item);
+        free(lp->l_key);
+        free(lp->l_val);
+        memset(lp, 0, sizeof *lp);
+    }
+    rs_nlists = 0;
+}
+
+/*
+ * rs_list_of:
+ *	Find, or make, the table for a list.  Returns NULL if there
+ *	isn't the memory for it.
+ */
+static struct rs_list *
+rs_list_of(THING *l, int by)
+{
+    struct rs_list *lp;
+    THING *tp;
+    void *key;
+    int i, h;
+
+    for (lp = rs_lists; lp < &rs_lists[NLISTS]; lp++)
+        if (lp->l_item != NULL && lp->l_head == l && lp->l_by == by)
+            return lp;
+
+    lp = &rs_lists[rs_nlists++ % NLISTS];
+    free(lp->l_item);
+    free(lp->l_key);
+    free(lp->l_val);
+    memset(lp, 0, sizeof *lp);
+    lp->l_head = l;
+    lp->l_by = by;
+    lp->l_n = list_size(l);
+    for (lp->l_size = 16; lp->l_size < 2 * lp->l_n; lp->l_size *= 2)
+        continue;
+    lp->l_item = malloc((lp->l_n + 1) * sizeof *lp->l_item);
+    lp->l_key = calloc(lp->l_size, sizeof *lp->l_key);
+    lp->l_val = malloc(lp->l_size * sizeof *lp->l_val);
+    if (lp->l_item == NULL || lp->l_key == NULL || lp->l_val == NULL)
+    {
+        free(lp->l_item);
+        free(lp->l_key);
+        free(lp->l_val);
+        memset(lp, 0, sizeof *lp);
+        return NULL;
+    }
+    for (i = 0, tp = l; tp != NULL; tp = tp->l_next, i++)
+    {
+        lp->l_item[i] = tp;
+        if (by == RS_BYMONPOS)
+            key = &tp->t_pos;
+        else if (by == RS_BYOBJPOS)
+            key = &tp->o_pos;
+        else
+            key = tp;
+        for (h = RS_HASH(key, lp->l_size); lp->l_key[h] != NULL;
+          h = (h + 1) & (lp->l_size - 1))
+            continue;
+        lp->l_key[h] = key;
+        lp->l_val[h] = i;
+    }
+    return lp;
+}
+
+/*
+ * rs_list_index:
+ *	Where something is on a list, or -1 if it isn't
+ */
+static int
+rs_list_index(THING *l, void *key, int by)
+{
+    struct rs_list *lp;
+    int h;
+
+    if (l == NULL || key == NULL)
+        return(-1);
+    if ((lp = rs_list_of(l, by)) == NULL)
+    {
+        write_error = 1;
+        return(-1);
+    }
+    for (h = RS_HASH(key, lp->l_size); lp->l_key[h] != NULL;
+      h = (h + 1) & (lp->l_size - 1))
+        if (lp->l_key[h] == key)
+            return(lp->l_val[h]);
+    return(-1);
+}
+
 void *
 get_list_item(THING *l, int i)
 {
-    int count;
+    struct rs_list *lp;
 
-    for(count = 0; l != NULL; count++, l = l->l_next)
-        if (count == i)
-            return(l);
-    
-    return(NULL);
+    if (l == NULL || i < 0)
+        return(NULL);
+    if ((lp = rs_list_of(l, RS_BYTHING)) == NULL)
+    {
+        read_error = 1;
+        return(NULL);
+    }
+    return(i < lp->l_n ? lp->l_item[i] : NULL);
 }
 
 int
 find_list_ptr(THING *l, void *ptr)
 {
-    int count;
-
-    for(count = 0; l != NULL; count++, l = l->l_next)
-        if (l == ptr)
-            return(count);
-    
-    return(-1);
+    return rs_list_index(l, ptr, RS_BYTHING);
 }
 
 int
 list_size(THING *l)
 {
-    int count;
+    int cnt;
     
-    for(count = 0; l != NULL; count++, l = l->l_next)
+    for(cnt = 0; l != NULL; cnt++, l = l->l_next)
         ;
     
-    return(count);
+    return(cnt);
 }
 
 /******************************************************************************/
@@ -837,6 +941,7 @@ rs_read_stats(FILE *inf, struct stats *s)
     rs_read_int(inf,&s->s_arm);
     rs_read_int(inf,&s->s_hpt);
     rs_read_chars(inf,s->s_dmg,sizeof(s->s_dmg));
+    set_dice(&s->s_dice, s->s_dmg);
     rs_read_int(inf,&s->s_maxhp);
 
     return(READSTAT);
@@ -1019,112 +1124,38 @@ rs_read_sticks(FILE *inf)
 }
 
 int
-rs_write_daemons(FILE *savef, struct delayed_action *d_list, int count)
-{
-    int i = 0;
-    int func = 0;
-        
-    if (write_error)
-        return(WRITESTAT);
-
-    rs_write_marker(savef, RSID_DAEMONS);
-    rs_write_int(savef, count);
-        
-    for(i = 0; i < count; i++)
-    {
-        if (d_list[i].d_func == rollwand)
-            func = 1;
-        else if (d_list[i].d_func == doctor)
-            func = 2;
-        else if (d_list[i].d_func == stomach)
-            func = 3;
-        else if (d_list[i].d_func == runners)
-            func = 4;
-        else if (d_list[i].d_func == swander)
-            func = 5;
-        else if (d_list[i].d_func == nohaste)
-            func = 6;
-        else if (d_list[i].d_func == unconfuse)
-            func = 7;
-        else if (d_list[i].d_func == unsee)
-            func = 8;
-        else if (d_list[i].d_func == sight)
-            func = 9;
-        else if (d_list[i].d_func == NULL)
-            func = 0;
-        else
-            func = -1;
-
-        rs_write_int(savef, d_list[i].d_type);
-        rs_write_int(savef, func);
-        rs_write_int(savef, d_list[i].d_arg);
-        rs_write_int(savef, d_list[i].d_time);
-    }
-    
-    return(WRITESTAT);
-}       
-
-int
-rs_read_daemons(FILE *inf, struct delayed_action *d_list, int count)
+rs_read_daemons(FILE *inf)
 {
     int i = 0;
-    int func = 0;
-    int value = 0;
+    int cnt = 0;
+    int type, func, arg, time;
     
     if (read_error || format_error)
         return(READSTAT);
 
     rs_read_marker(inf, RSID_DAEMONS);
-    rs_read_int(inf, &value);
+    rs_read_int(inf, &cnt);
 
-    if (value > count)
+    if (cnt < 0 || cnt > 0xffff)
         format_error = TRUE;
 
-    for(i=0; i < count; i++)
+    for(i = 0; i < cnt && !read_error && !format_error; i++)
     {
-        func = 0;
-        rs_read_int(inf, &d_list[i].d_type);
+        type = func = arg = time = 0;
+        rs_read_int(inf, &type);
         rs_read_int(inf, &func);
-        rs_read_int(inf, &d_list[i].d_arg);
-        rs_read_int(inf, &d_list[i].d_time);
-                    
-        switch(func)
-        {
-            case 1: d_list[i].d_func = rollwand;
-                    break;
-            case 2: d_list[i].d_func = doctor;
-                    break;
-            case 3: d_list[i].d_func = stomach;
-                    break;
-            case 4: d_list[i].d_func = runners;
-                    break;
-            case 5: d_list[i].d_func = swander;
-                    break;
-            case 6: d_list[i].d_func = nohaste;
-                    break;
-            case 7: d_list[i].d_func = unconfuse;
-                    break;
-            case 8: d_list[i].d_func = unsee;
-                    break;
-            case 9: d_list[i].d_func = sight;
-                    break;
-            default:d_list[i].d_func = NULL;
-                    break;
-        }
-    }
+        rs_read_int(inf, &arg);
+        rs_read_int(inf, &time);
 
-    if (d_list[i].d_func == NULL)
-    {
-        d_list[i].d_type = 0;
-        d_list[i].d_arg = 0;
-        d_list[i].d_time = 0;
+        if (type != 0 && func > 0 && func < NDFUNCS)
+            d_restore(i, type, d_funcs[func], arg, time);
     }
-    
+
     return(READSTAT);
 }       
         
 int
-rs_write_obj_info(FILE *savef, struct obj_info *i, int count)
+rs_write_obj_info(FILE *savef, struct obj_info *i, int cnt)
 {
     int n;
     
@@ -1132,9 +1163,9 @@ rs_write_obj_info(FILE *savef, struct obj_info *i, int count)
         return(WRITESTAT);
 
     rs_write_marker(savef, RSID_MAGICITEMS);
-    rs_write_int(savef, count);
+    rs_write_int(savef, cnt);
 
-    for(n = 0; n < count; n++)
+    for(n = 0; n < cnt; n++)
     {
         /* mi_name is constant, defined at compile time in all cases */
         rs_write_int(savef,i[n].oi_prob);
@@ -1147,7 +1178,7 @@ rs_write_obj_info(FILE *savef, struct obj_info *i, int count)
 }
 
 int
-rs_read_obj_info(FILE *inf, struct obj_info *mi, int count)
+rs_read_obj_info(FILE *inf, struct obj_info *mi, int cnt)
 {
     int n;
     int value;
@@ -1159,7 +1190,7 @@ rs_read_obj_info(FILE *inf, struct obj_info *mi, int count)
 
     rs_read_int(inf, &value);
 
-    if (value > count)
+    if (value > cnt)
         format_error = TRUE;
 
     for(n = 0; n < value; n++)
@@ -1231,23 +1262,23 @@ rs_read_room(FILE *inf, struct room *r)
 }
 
 int
-rs_write_rooms(FILE *savef, struct room r[], int count)
+rs_write_rooms(FILE *savef, struct room r[], int cnt)
 {
     int n = 0;
 
     if (write_error)
         return(WRITESTAT);
 
-    rs_write_int(savef, count);
+    rs_write_int(savef, cnt);
     
-    for(n = 0; n < count; n++)
+    for(n = 0; n < cnt; n++)
         rs_write_room(savef, &r[n]);
     
     return(WRITESTAT);
 }
 
 int
-rs_read_rooms(FILE *inf, struct room *r, int count)
+rs_read_rooms(FILE *inf, struct room *r, int cnt)
 {
     int value = 0, n = 0;
 
@@ -1256,7 +1287,7 @@ rs_read_rooms(FILE *inf, struct room *r, int count)
 
     rs_read_int(inf,&value);
 
-    if (value > count)
+    if (value > cnt)
         format_error = TRUE;
 
     for(n = 0; n < value; n++)
@@ -1298,7 +1329,7 @@ rs_read_room_reference(FILE *inf, struct room **rp)
 }
 
 int
-rs_write_monsters(FILE *savef, struct monster *m, int count)
+rs_write_monsters(FILE *savef, struct monster *m, int cnt)
 {
     int n;
     
@@ -1306,16 +1337,16 @@ rs_write_monsters(FILE *savef, struct monster *m, int count)
         return(WRITESTAT);
 
     rs_write_marker(savef, RSID_MONSTERS);
-    rs_write_int(savef, count);
+    rs_write_int(savef, cnt);
 
-    for(n=0;n<count;n++)
+    for(n=0;n<cnt;n++)
         rs_write_stats(savef, &m[n].m_stats);
     
     return(WRITESTAT);
 }
 
 int
-rs_read_monsters(FILE *inf, struct monster *m, int count)
+rs_read_monsters(FILE *inf, struct monster *m, int cnt)
 {
     int value = 0, n = 0;
 
@@ -1326,10 +1357,10 @@ rs_read_monsters(FILE *inf, struct monster *m, int count)
 
     rs_read_int(inf, &value);
 
-    if (value != count)
+    if (value != cnt)
         format_error = TRUE;
 
-    for(n = 0; n < count; n++)
+    for(n = 0; n < cnt; n++)
         rs_read_stats(inf, &m[n].m_stats);
     
     return(READSTAT);
@@ -1372,6 +1403,8 @@ rs_read_object(FILE *inf, THING *o)
     rs_read_char(inf, &o->_o._o_packch);
     rs_read_chars(inf, o->_o._o_damage, sizeof(o->_o._o_damage));
     rs_read_chars(inf, o->_o._o_hurldmg, sizeof(o->_o._o_hurldmg));
+    set_dice(&o->o_dice, o->o_damage);
+    set_dice(&o->o_hurldice, o->o_hurldmg);
     rs_read_int(inf, &o->_o._o_count);
     rs_read_int(inf, &o->_o._o_which);
     rs_read_int(inf, &o->_o._o_hplus);
@@ -1471,53 +1504,26 @@ rs_read_object_reference(FILE *inf, THING *list, THING **item)
 int
 find_room_coord(struct room *rmlist, coord *c, int n)
 {
-    int i = 0;
-    
-    for(i = 0; i < n; i++)
-        if(&rmlist[i].r_gold == c)
-            return(i);
-    
-    return(-1);
+    size_t off;
+
+    if ((char *) c < (char *) &rmlist[0].r_gold)
+        return(-1);
+    off = (char *) c - (char *) &rmlist[0].r_gold;
+    if (off % sizeof *rmlist != 0 || off / sizeof *rmlist >= (size_t) n)
+        return(-1);
+    return((int) (off / sizeof *rmlist));
 }
 
 int
 find_thing_coord(THING *monlist, coord *c)
 {
-    THING *mitem;
-    THING *tp;
-    int i = 0;
-
-    for(mitem = monlist; mitem != NULL; mitem = mitem->l_next)
-    {
-        tp = mitem;
-
-        if (c == &tp->t_pos)
-            return(i);
-
-        i++;
-    }
-
-    return(-1);
+    return rs_list_index(monlist, c, RS_BYMONPOS);
 }
 
 int
 find_object_coord(THING *objlist, coord *c)
 {
-    THING *oitem;
-    THING *obj;
-    int i = 0;
-
-    for(oitem = objlist; oitem != NULL; oitem = oitem->l_next)
-    {
-        obj = oitem;
-
-        if (c == &obj->o_pos)
-            return(i);
-
-        i++;
-    }
-
-    return(-1);
+    return rs_list_index(objlist, c, RS_BYOBJPOS);
 }
 
 int
@@ -1815,71 +1821,118 @@ rs_read_thing_reference(FILE *inf, THING *list, THING **item)
 }
 
 int
-rs_write_thing_references(FILE *savef, THING *list, THING *items[], int count)
+rs_write_thing_references(FILE *savef, THING *list, THING *items[], int cnt)
 {
     int i;
 
     if (write_error)
         return(WRITESTAT);
 
-    for(i = 0; i < count; i++)
+    for(i = 0; i < cnt; i++)
         rs_write_thing_reference(savef,list,items[i]);
 
     return(WRITESTAT);
 }
 
 int
-rs_read_thing_references(FILE *inf, THING *list, THING *items[], int count)
+rs_read_thing_references(FILE *inf, THING *list, THING *items[], int cnt)
 {
     int i;
 
     if (read_error || format_error)
         return(READSTAT);
 
-    for(i = 0; i < count; i++)
+    for(i = 0; i < cnt; i++)
         rs_read_thing_reference(inf,list,&items[i]);
 
     return(WRITESTAT);
 }
 
+/*
+ * Old saves have the map a column at a time, the way it used to be
+ * laid out in memory
+ */
 int 
-rs_write_places(FILE *savef, PLACE *places, int count)
+rs_read_places(FILE *inf, MAP *pl)
 {
-    int i = 0;
+    int x, y, i;
+    THING *tp;
     
+    if (read_error || format_error)
+        return(READSTAT);
+
+    for (tp = mlist; tp != NULL; tp = next(tp))
+        new_slot(tp);
+
+    for(x = 0; x < MAXCOLS; x++) 
+        for(y = 0; y < MAXLINES; y++)
+        {
+            i = INDEX(y, x);
+            rs_read_char(inf,&pl->p_ch[i]);
+            rs_read_char(inf,&pl->p_flags[i]);
+            rs_read_thing_reference(inf, mlist, &tp);
+            pl->p_mon[i] = (tp == NULL ? 0 : tp->t_slot);
+        }
+
+    return(READSTAT);
+}
+
+int
+rs_write_rng(FILE *savef, struct rng *rp)
+{
+    int i;
+
     if (write_error)
         return(WRITESTAT);
 
-    for(i = 0; i < count; i++) 
-    {
-        rs_write_char(savef, places[i].p_ch);
-        rs_write_char(savef, places[i].p_flags);
-        rs_write_thing_reference(savef, mlist, places[i].p_monst);
-    }
+    rs_write_marker(savef, RSID_RNG);
+    rs_write_int(savef, rp->r_engine);
+    for (i = 0; i < 4; i++)
+        rs_write_uint(savef, rp->r_s[i]);
 
     return(WRITESTAT);
 }
 
-int 
-rs_read_places(FILE *inf, PLACE *places, int count)
+/*
+ * Saves from before there was a choice of engine stop short of the
+ * generator block; they were all using the classic one
+ */
+int
+rs_read_rng(FILE *inf, struct rng *rp)
 {
-    int i = 0;
-    
+    int i, id, engine;
+
     if (read_error || format_error)
         return(READSTAT);
 
-    for(i = 0; i < count; i++) 
+    rp->r_engine = RNG_CLASSIC;
+    rs_read_int(inf, &id);
+    if (read_error)
+    {
+        read_error = 0;
+        return(READSTAT);
+    }
+    if (id != RSID_RNG)
+        format_error = 1;
+    rs_read_int(inf, &engine);
+    for (i = 0; i < 4; i++)
+        rs_read_uint(inf, &rp->r_s[i]);
+    if (READSTAT == 0)
     {
-        rs_read_char(inf,&places[i].p_ch);
-        rs_read_char(inf,&places[i].p_flags);
-        rs_read_thing_reference(inf, mlist, &places[i].p_monst);
+        if (engine < 0 || engine >= NRNG)
+            format_error = 1;
+        else
+            rp->r_engine = engine;
     }
 
     return(READSTAT);
 }
 
+/*
+ * The variables that go at the top of every save file, old or new
+ */
 int
-rs_save_file(FILE *savef)
+rs_write_vars(FILE *savef)
 {
     if (write_error)
         return(WRITESTAT);
@@ -1963,51 +2016,11 @@ rs_save_file(FILE *savef)
     rs_write_coord(savef, oldpos);
     rs_write_coord(savef, stairs);
 
-    rs_write_thing(savef, &player);                     
-    rs_write_object_reference(savef, player.t_pack, cur_armor);
-    rs_write_object_reference(savef, player.t_pack, cur_ring[0]);
-    rs_write_object_reference(savef, player.t_pack, cur_ring[1]); 
-    rs_write_object_reference(savef, player.t_pack, cur_weapon); 
-    rs_write_object_reference(savef, player.t_pack, l_last_pick); 
-    rs_write_object_reference(savef, player.t_pack, last_pick); 
-    
-    rs_write_object_list(savef, lvl_obj);               
-    rs_write_thing_list(savef, mlist);                
-
-    rs_write_places(savef,places,MAXLINES*MAXCOLS);
-
-    rs_write_stats(savef,&max_stats); 
-    rs_write_rooms(savef, rooms, MAXROOMS);             
-    rs_write_room_reference(savef, oldrp);              
-    rs_write_rooms(savef, passages, MAXPASS);
-
-    rs_write_monsters(savef,monsters,26);               
-    rs_write_obj_info(savef, things,   NUMTHINGS);   
-    rs_write_obj_info(savef, arm_info,  MAXARMORS);  
-    rs_write_obj_info(savef, pot_info,  MAXPOTIONS);  
-    rs_write_obj_info(savef, ring_info,  MAXRINGS);    
-    rs_write_obj_info(savef, scr_info,  MAXSCROLLS);  
-    rs_write_obj_info(savef, weap_info,  MAXWEAPONS+1);  
-    rs_write_obj_info(savef, ws_info, MAXSTICKS);      
-    
-    
-    rs_write_daemons(savef, &d_list[0], 20);            /* 5.4-daemon.c */
-#ifdef MASTER
-    rs_write_int(savef,total);                          /* 5.4-list.c   */
-#else
-    rs_write_int(savef, 0);
-#endif
-    rs_write_int(savef,between);                        /* 5.4-daemons.c*/
-    rs_write_coord(savef, nh);                          /* 5.4-move.c    */
-    rs_write_int(savef, group);                         /* 5.4-weapons.c */
-
-    rs_write_window(savef,stdscr);
-
     return(WRITESTAT);
 }
 
 int
-rs_restore_file(FILE *inf)
+rs_read_vars(FILE *inf)
 {
     int dummyint;
 
@@ -2093,42 +2106,811 @@ rs_restore_file(FILE *inf)
     rs_read_coord(inf, &oldpos);
     rs_read_coord(inf, &stairs);
 
-    rs_read_thing(inf, &player); 
-    rs_read_object_reference(inf, player.t_pack, &cur_armor);
-    rs_read_object_reference(inf, player.t_pack, &cur_ring[0]);
-    rs_read_object_reference(inf, player.t_pack, &cur_ring[1]);
-    rs_read_object_reference(inf, player.t_pack, &cur_weapon);
-    rs_read_object_reference(inf, player.t_pack, &l_last_pick);
-    rs_read_object_reference(inf, player.t_pack, &last_pick);
+    return(READSTAT);
+}
 
-    rs_read_object_list(inf, &lvl_obj);                 
-    rs_read_thing_list(inf, &mlist);                  
-    rs_fix_thing(&player);
-    rs_fix_thing_list(mlist);
+/*
+ * A save file is a short header followed by sections:
+ *
+ *	header:		RS_MAGIC, RS_FORMAT, number of sections
+ *	section:	id, length, checksum, then length bytes of data
+ *
+ * Everything is little-endian.  The header and the id, length and
+ * checksum of each section are in the clear; a section's data is
+ * scrambled on its own (see savecrypt()), and the checksum is an
+ * Adler-32 of the data as it is in the file, so it can be checked
+ * without unscrambling anything.  Sections can come in any order and
+ * ones we don't know are skipped, and a section can grow new fields
+ * on the end without older readers minding, so the file is easy to
+ * pick apart with other tools.  The big arrays (the map, the fuses and
+ * daemons, the screen) are written as raw arrays and read back in one
+ * go.
+ */
+#define RS_MAGIC          0x56534752	/* "RGSV" */
+#define RS_FORMAT         2
+
+#define RSEC_GLOBALS      1
+#define RSEC_PLAYER       2
+#define RSEC_PACK         3
+#define RSEC_LEVEL        4
+#define RSEC_MONSTERS     5
+#define RSEC_OBJECTS      6
+#define RSEC_DAEMONS      7
+#define RSEC_WINDOW       8	/* Format 1 screen, read only */
+#define RSEC_SCREEN       9
+#define RSEC_MAX          10
+
+#define rs_shadow_ch(c)   (((c) & 0x7f) | (((c) & 0x80) ? A_STANDOUT : 0))
+
+struct rs_section {
+    size_t s_pos;			/* Where its data starts */
+    unsigned int s_len;			/* How long it is */
+    bool s_found;			/* It was in the file */
+};
+
+static TLOCAL size_t sec_start;		/* Section being written */
 
-    rs_read_places(inf,places,MAXLINES*MAXCOLS);
+/*
+ * rs_sum:
+ *	Checksum a section
+ */
+static unsigned int
+rs_sum(unsigned char *p, size_t len)
+{
+    unsigned int a = 1, b = 0;
+    size_t n;
 
-    rs_read_stats(inf, &max_stats);
-    rs_read_rooms(inf, rooms, MAXROOMS);
-    rs_read_room_reference(inf, &oldrp);
-    rs_read_rooms(inf, passages, MAXPASS);
+    while (len > 0)
+    {
+        n = (len < 5552 ? len : 5552);
+        len -= n;
+        while (n-- > 0)
+        {
+            a += *p++;
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    return (b << 16) | a;
+}
 
-    rs_read_monsters(inf,monsters,26);                  
-    rs_read_obj_info(inf, things,   NUMTHINGS);         
-    rs_read_obj_info(inf, arm_info,   MAXARMORS);         
-    rs_read_obj_info(inf, pot_info,  MAXPOTIONS);       
-    rs_read_obj_info(inf, ring_info,  MAXRINGS);         
-    rs_read_obj_info(inf, scr_info,  MAXSCROLLS);       
-    rs_read_obj_info(inf, weap_info, MAXWEAPONS+1);       
-    rs_read_obj_info(inf, ws_info, MAXSTICKS);       
+static void
+rs_put_uint(char *p, unsigned int v)
+{
+    p[0] = (char) (v & 0xff);
+    p[1] = (char) ((v >> 8) & 0xff);
+    p[2] = (char) ((v >> 16) & 0xff);
+    p[3] = (char) ((v >> 24) & 0xff);
+}
 
-    rs_read_daemons(inf, d_list, 20);                   /* 5.4-daemon.c     */
-    rs_read_int(inf,&dummyint);  /* total */            /* 5.4-list.c    */
-    rs_read_int(inf,&between);                          /* 5.4-daemons.c    */
-    rs_read_coord(inf, &nh);                            /* 5.4-move.c       */
-    rs_read_int(inf,&group);                            /* 5.4-weapons.c    */
-    
-    rs_read_window(inf,stdscr);
+/*
+ * Raw arrays of 2 or 4 byte values, swapped a bit at a time on
+ * big-endian machines
+ */
+int
+rs_write_array(FILE *savef, void *ptr, int cnt, int size)
+{
+    unsigned char buf[BUFSIZ], *p = ptr;
+    int i, j, n;
+
+    if (write_error)
+        return(WRITESTAT);
+
+    if (!big_endian)
+        return rs_write(savef, ptr, (size_t) cnt * size);
+
+    while (cnt > 0)
+    {
+        n = (cnt < BUFSIZ / size ? cnt : BUFSIZ / size);
+        for (i = 0; i < n; i++, p += size)
+            for (j = 0; j < size; j++)
+                buf[i * size + j] = p[size - 1 - j];
+        rs_write(savef, buf, (size_t) n * size);
+        cnt -= n;
+    }
+
+    return(WRITESTAT);
+}
+
+int
+rs_read_array(FILE *inf, void *ptr, int cnt, int size)
+{
+    unsigned char *p = ptr, c;
+    int i, j;
+
+    if (read_error || format_error)
+        return(READSTAT);
+
+    rs_read(inf, ptr, (size_t) cnt * size);
+
+    if (big_endian)
+        for (i = 0; i < cnt; i++, p += size)
+            for (j = 0; j < size / 2; j++)
+            {
+                c = p[j];
+                p[j] = p[size - 1 - j];
+                p[size - 1 - j] = c;
+            }
+
+    return(READSTAT);
+}
+
+int
+rs_begin_section(FILE *savef, int id)
+{
+    if (write_error)
+        return(WRITESTAT);
+
+    sec_start = savepos();
+    rs_write_int(savef, id);
+    rs_write_uint(savef, 0);
+    rs_write_uint(savef, 0);
+
+    return(WRITESTAT);
+}
+
+/*
+ * Go back and fill in the length and checksum
+ */
+int
+rs_end_section(FILE *savef)
+{
+    size_t len;
+    char *p;
+
+    if (write_error)
+        return(WRITESTAT);
+
+    len = savepos() - sec_start - 12;
+    if ((p = saveat(sec_start, len + 12)) == NULL)
+        write_error = 1;
+    else
+    {
+        savecrypt(sec_start + 12, len);
+        rs_put_uint(p + 4, (unsigned int) len);
+        rs_put_uint(p + 8, rs_sum((unsigned char *) p + 12, len));
+    }
+
+    return(WRITESTAT);
+}
+
+int
+rs_write_globals(FILE *savef)
+{
+    if (write_error)
+        return(WRITESTAT);
+
+    rs_write_vars(savef);
+    rs_write_monsters(savef,monsters,26);
+    rs_write_obj_info(savef, things,   NUMTHINGS);
+    rs_write_obj_info(savef, arm_info,  MAXARMORS);
+    rs_write_obj_info(savef, pot_info,  MAXPOTIONS);
+    rs_write_obj_info(savef, ring_info,  MAXRINGS);
+    rs_write_obj_info(savef, scr_info,  MAXSCROLLS);
+    rs_write_obj_info(savef, weap_info,  MAXWEAPONS+1);
+    rs_write_obj_info(savef, ws_info, MAXSTICKS);
+    rs_write_int(savef, between);
+    rs_write_coord(savef, nh);
+    rs_write_int(savef, group);
+    rs_write_rng(savef, &game->g_rng);
+    rs_write_int(savef, turns);
+    rs_write_boolean(savef, flowchase);
+
+    return(WRITESTAT);
+}
+
+int
+rs_read_globals(FILE *inf)
+{
+    if (read_error || format_error)
+        return(READSTAT);
+
+    rs_read_vars(inf);
+    rs_read_monsters(inf,monsters,26);
+    rs_read_obj_info(inf, things,   NUMTHINGS);
+    rs_read_obj_info(inf, arm_info,   MAXARMORS);
+    rs_read_obj_info(inf, pot_info,  MAXPOTIONS);
+    rs_read_obj_info(inf, ring_info,  MAXRINGS);
+    rs_read_obj_info(inf, scr_info,  MAXSCROLLS);
+    rs_read_obj_info(inf, weap_info, MAXWEAPONS+1);
+    rs_read_obj_info(inf, ws_info, MAXSTICKS);
+    rs_read_int(inf, &between);
+    rs_read_coord(inf, &nh);
+    rs_read_int(inf, &group);
+    rs_read_rng(inf, &game->g_rng);
+
+    return(READSTAT);
+}
+
+/*
+ * The hero, less the pack, which has its own section
+ */
+int
+rs_write_player(FILE *savef)
+{
+    THING p;
+
+    if (write_error)
+        return(WRITESTAT);
+
+    p = player;
+    p.t_pack = NULL;
+    rs_write_thing(savef, &p);
+    rs_write_stats(savef, &max_stats);
+
+    return(WRITESTAT);
+}
+
+int
+rs_read_player(FILE *inf)
+{
+    if (read_error || format_error)
+        return(READSTAT);
+
+    rs_read_thing(inf, &player);
+    rs_read_stats(inf, &max_stats);
+
+    return(READSTAT);
+}
+
+int
+rs_write_pack(FILE *savef)
+{
+    if (write_error)
+        return(WRITESTAT);
+
+    rs_write_object_list(savef, player.t_pack);
+    rs_write_object_reference(savef, player.t_pack, cur_armor);
+    rs_write_object_reference(savef, player.t_pack, cur_ring[0]);
+    rs_write_object_reference(savef, player.t_pack, cur_ring[1]);
+    rs_write_object_reference(savef, player.t_pack, cur_weapon);
+    rs_write_object_reference(savef, player.t_pack, l_last_pick);
+    rs_write_object_reference(savef, player.t_pack, last_pick);
+
+    return(WRITESTAT);
+}
+
+int
+rs_read_pack(FILE *inf)
+{
+    if (read_error || format_error)
+        return(READSTAT);
+
+    rs_read_object_list(inf, &player.t_pack);
+    rs_read_object_reference(inf, player.t_pack, &cur_armor);
+    rs_read_object_reference(inf, player.t_pack, &cur_ring[0]);
+    rs_read_object_reference(inf, player.t_pack, &cur_ring[1]);
+    rs_read_object_reference(inf, player.t_pack, &cur_weapon);
+    rs_read_object_reference(inf, player.t_pack, &l_last_pick);
+    rs_read_object_reference(inf, player.t_pack, &last_pick);
+
+    return(READSTAT);
+}
+
+/*
+ * The rooms and the map.  The map is in the same order as in memory,
+ * with monsters kept as where they are in mlist plus one, not as
+ * their slots.
+ */
+int
+rs_write_level(FILE *savef)
+{
+    static TLOCAL unsigned short mon[MAXLINES*MAXCOLS];
+    unsigned short *where;
+    THING *tp;
+    int i, n;
+
+    if (write_error)
+        return(WRITESTAT);
+
+    rs_write_rooms(savef, rooms, MAXROOMS);
+    rs_write_room_reference(savef, oldrp);
+    rs_write_rooms(savef, passages, MAXPASS);
+
+    if ((where = calloc(game->g_nmslot, sizeof *where)) == NULL)
+    {
+        write_error = 1;
+        return(WRITESTAT);
+    }
+    for (n = 1, tp = mlist; tp != NULL; tp = next(tp), n++)
+        where[tp->t_slot] = n;
+    for (i = 0; i < MAXLINES*MAXCOLS; i++)
+        mon[i] = where[places.p_mon[i]];
+    free(where);
+
+    rs_write_int(savef, MAXLINES);
+    rs_write_int(savef, MAXCOLS);
+    rs_write(savef, places.p_ch, MAXLINES*MAXCOLS);
+    rs_write(savef, places.p_flags, MAXLINES*MAXCOLS);
+    rs_write_array(savef, mon, MAXLINES*MAXCOLS, sizeof *mon);
+
+    return(WRITESTAT);
+}
+
+int
+rs_read_level(FILE *inf)
+{
+    static TLOCAL unsigned short mon[MAXLINES*MAXCOLS];
+    struct room *rp;
+    THING **list, *tp;
+    int i, n, lines, cols;
+
+    if (read_error || format_error)
+        return(READSTAT);
+
+    rs_read_rooms(inf, rooms, MAXROOMS);
+    for (rp = rooms; rp < &rooms[MAXROOMS]; rp++)
+        mark_room(rp);
+    rs_read_room_reference(inf, &oldrp);
+    rs_read_rooms(inf, passages, MAXPASS);
+
+    rs_read_int(inf, &lines);
+    rs_read_int(inf, &cols);
+    if (READSTAT == 0 && (lines != MAXLINES || cols != MAXCOLS))
+        format_error = TRUE;
+    rs_read(inf, places.p_ch, MAXLINES*MAXCOLS);
+    rs_read(inf, places.p_flags, MAXLINES*MAXCOLS);
+    rs_read_array(inf, mon, MAXLINES*MAXCOLS, sizeof *mon);
+    if (READSTAT != 0)
+        return(READSTAT);
+
+    n = list_size(mlist);
+    if ((list = malloc((n + 1) * sizeof *list)) == NULL)
+    {
+        read_error = 1;
+        return(READSTAT);
+    }
+    for (i = 0, tp = mlist; tp != NULL; tp = next(tp))
+    {
+        new_slot(tp);
+        list[++i] = tp;
+    }
+    for (i = 0; i < MAXLINES*MAXCOLS; i++)
+        if (mon[i] > n)
+            format_error = TRUE;
+        else
+            places.p_mon[i] = (mon[i] == 0 ? 0 : list[mon[i]]->t_slot);
+    free(list);
+
+    return(READSTAT);
+}
+
+/*
+ * The fuses and daemons, four ints a slot: type, function, argument
+ * and turns left
+ */
+int
+rs_write_daemon_array(FILE *savef, struct sched *sp)
+{
+    struct delayed_action *dev;
+    int i, *d;
+
+    if (write_error)
+        return(WRITESTAT);
+
+    if ((d = calloc(sp->s_nslot * 4 + 1, sizeof *d)) == NULL)
+    {
+        write_error = 1;
+        return(WRITESTAT);
+    }
+    for (i = 0; i < sp->s_nslot; i++)
+    {
+        dev = &sp->s_slot[i];
+        if (dev->d_type == 0)
+            continue;
+        d[i * 4] = dev->d_type;
+        d[i * 4 + 1] = d_func_id(dev->d_func);
+        d[i * 4 + 2] = dev->d_arg;
+        d[i * 4 + 3] = d_left(dev);
+    }
+    rs_write_int(savef, sp->s_nslot);
+    rs_write_array(savef, d, sp->s_nslot * 4, sizeof *d);
+    free(d);
+
+    return(WRITESTAT);
+}
+
+int
+rs_read_daemon_array(FILE *inf)
+{
+    int i, cnt, *d;
+
+    if (read_error || format_error)
+        return(READSTAT);
+
+    rs_read_int(inf, &cnt);
+    if (READSTAT != 0 || cnt < 0 || cnt > 0xffff)
+    {
+        format_error = TRUE;
+        return(READSTAT);
+    }
+    if ((d = malloc((cnt * 4 + 1) * sizeof *d)) == NULL)
+    {
+        read_error = 1;
+        return(READSTAT);
+    }
+    rs_read_array(inf, d, cnt * 4, sizeof *d);
+    if (READSTAT == 0)
+        for (i = 0; i < cnt; i++)
+            if (d[i * 4] != 0 && d[i * 4 + 1] > 0 && d[i * 4 + 1] < NDFUNCS)
+                d_restore(i, d[i * 4], d_funcs[d[i * 4 + 1]],
+                          d[i * 4 + 2], d[i * 4 + 3]);
+    free(d);
+
+    return(READSTAT);
+}
+
+/*
+ * The screen is saved straight out of the shadow screen, a byte a
+ * place with the top bit for standout
+ */
+int
+rs_write_shadow(FILE *savef)
+{
+    unsigned char *s;
+    int height, width;
+
+    if (write_error)
+        return(WRITESTAT);
+
+    s = sh_at(&height, &width);
+    rs_write_int(savef, height);
+    rs_write_int(savef, width);
+    rs_write(savef, s, (size_t) height * width);
+
+    return(WRITESTAT);
+}
+
+int
+rs_read_shadow(FILE *inf)
+{
+    int row, col, height, width, maxlines, maxcols;
+    unsigned char *s;
+
+    if (read_error || format_error)
+        return(READSTAT);
+
+    width  = getmaxx(stdscr);
+    height = getmaxy(stdscr);
+
+    rs_read_int(inf, &maxlines);
+    rs_read_int(inf, &maxcols);
+    if (READSTAT != 0 || maxlines < 0 || maxcols < 0
+      || maxlines > 0x7fff / (maxcols + 1))
+    {
+        format_error = TRUE;
+        return(READSTAT);
+    }
+    if ((s = malloc(maxlines * maxcols + 1)) == NULL)
+    {
+        read_error = 1;
+        return(READSTAT);
+    }
+    rs_read(inf, s, (size_t) maxlines * maxcols);
+    if (READSTAT == 0)
+        for (row = 0; row < maxlines && row < height; row++)
+            for (col = 0; col < maxcols && col < width; col++)
+                mvaddch(row, col, rs_shadow_ch(s[row * maxcols + col]));
+    free(s);
+
+    return(READSTAT);
+}
+
+/*
+ * Screens saved before the shadow screen, as curses chtypes
+ */
+int
+rs_read_screen(FILE *inf, WINDOW *win)
+{
+    int row, col, height, width, maxlines, maxcols, *s;
+
+    if (read_error || format_error)
+        return(READSTAT);
+
+    width  = getmaxx(win);
+    height = getmaxy(win);
+
+    rs_read_int(inf, &maxlines);
+    rs_read_int(inf, &maxcols);
+    if (READSTAT != 0 || maxlines < 0 || maxcols < 0
+      || maxlines > 0x7fff / (maxcols + 1))
+    {
+        format_error = TRUE;
+        return(READSTAT);
+    }
+    if ((s = malloc((maxlines * maxcols + 1) * sizeof *s)) == NULL)
+    {
+        read_error = 1;
+        return(READSTAT);
+    }
+    rs_read_array(inf, s, maxlines * maxcols, sizeof *s);
+    if (READSTAT == 0)
+        for (row = 0; row < maxlines && row < height; row++)
+            for (col = 0; col < maxcols && col < width; col++)
+                mvaddch(row, col, s[row * maxcols + col]);
+    free(s);
+
+    return(READSTAT);
+}
+
+int
+rs_save_file(FILE *savef)
+{
+    if (write_error)
+        return(WRITESTAT);
+
+    rs_forget_lists();
+
+    rs_write_uint(savef, RS_MAGIC);
+    rs_write_int(savef, RS_FORMAT);
+    rs_write_int(savef, RSEC_MAX - 2);	/* All but RSEC_WINDOW */
+
+    rs_begin_section(savef, RSEC_GLOBALS);
+    rs_write_globals(savef);
+    rs_end_section(savef);
+
+    rs_begin_section(savef, RSEC_OBJECTS);
+    rs_write_object_list(savef, lvl_obj);
+    rs_end_section(savef);
+
+    rs_begin_section(savef, RSEC_MONSTERS);
+    rs_write_thing_list(savef, mlist);
+    rs_end_section(savef);
+
+    rs_begin_section(savef, RSEC_PLAYER);
+    rs_write_player(savef);
+    rs_end_section(savef);
+
+    rs_begin_section(savef, RSEC_PACK);
+    rs_write_pack(savef);
+    rs_end_section(savef);
+
+    rs_begin_section(savef, RSEC_LEVEL);
+    rs_write_level(savef);
+    rs_end_section(savef);
+
+    rs_begin_section(savef, RSEC_DAEMONS);
+    rs_write_daemon_array(savef, &game->g_sched);
+    rs_end_section(savef);
+
+    rs_begin_section(savef, RSEC_SCREEN);
+    rs_write_shadow(savef);
+    rs_end_section(savef);
+
+    rs_forget_lists();
+
+    return(WRITESTAT);
+}
+
+/*
+ * Find all the sections, checking each one's checksum
+ */
+int
+rs_read_sections(FILE *inf, struct rs_section sect[])
+{
+    int i, nsect, id, format;
+    unsigned int len, sum;
+    char *p;
+
+    if (read_error || format_error)
+        return(READSTAT);
+
+    rs_read_int(inf, &format);
+    rs_read_int(inf, &nsect);
+    /*
+     * A save from a later format can't be trusted to mean what this
+     * one would, so it is refused rather than half read
+     */
+    if (READSTAT != 0 || format < 1 || format > RS_FORMAT || nsect < 0)
+        format_error = TRUE;
+
+    for (i = 0; i < RSEC_MAX; i++)
+        sect[i].s_found = FALSE;
+    for (i = 0; i < nsect && READSTAT == 0; i++)
+    {
+        rs_read_int(inf, &id);
+        rs_read_uint(inf, &len);
+        rs_read_uint(inf, &sum);
+        if (READSTAT != 0)
+            break;
+        if ((p = saveat(savepos(), len)) == NULL
+          || rs_sum((unsigned char *) p, len) != sum)
+        {
+            format_error = TRUE;
+            break;
+        }
+        savecrypt(savepos(), len);
+        if (id > 0 && id < RSEC_MAX && !sect[id].s_found)
+        {
+            sect[id].s_pos = savepos();
+            sect[id].s_len = len;
+            sect[id].s_found = TRUE;
+        }
+        saveseek(savepos() + len);
+    }
+
+    return(READSTAT);
+}
+
+/*
+ * Go to a section before reading it, and check afterwards that it
+ * didn't run past its end
+ */
+int
+rs_seek_section(struct rs_section sect[], int id)
+{
+    if (read_error || format_error)
+        return(READSTAT);
+
+    if (!sect[id].s_found)
+        format_error = TRUE;
+    else
+        saveseek(sect[id].s_pos);
+
+    return(READSTAT);
+}
+
+/*
+ * Is there more of a section still to read?  Fields on the end of a
+ * section are missing from saves made before they were added.
+ */
+static bool
+rs_more_section(struct rs_section sect[], int id)
+{
+    return (READSTAT == 0 && savepos() < sect[id].s_pos + sect[id].s_len);
+}
+
+int
+rs_check_section(struct rs_section sect[], int id)
+{
+    if (read_error || format_error)
+        return(READSTAT);
+
+    if (savepos() > sect[id].s_pos + sect[id].s_len)
+        format_error = TRUE;
+
+    return(READSTAT);
+}
+
+/*
+ * Saves from before there were sections: one long run of fields
+ */
+static int
+rs_restore_fields(FILE *inf)
+{
+    int dummyint;
+    struct room *rp;
+
+    if (read_error || format_error)
+        return(READSTAT);
+
+    rs_read_vars(inf);
+
+    rs_read_thing(inf, &player); 
+    rs_read_object_reference(inf, player.t_pack, &cur_armor);
+    rs_read_object_reference(inf, player.t_pack, &cur_ring[0]);
+    rs_read_object_reference(inf, player.t_pack, &cur_ring[1]);
+    rs_read_object_reference(inf, player.t_pack, &cur_weapon);
+    rs_read_object_reference(inf, player.t_pack, &l_last_pick);
+    rs_read_object_reference(inf, player.t_pack, &last_pick);
+
+    rs_read_object_list(inf, &lvl_obj);                 
+    rs_read_thing_list(inf, &mlist);                  
+    rs_fix_thing(&player);
+    rs_fix_thing_list(mlist);
+
+    rs_read_places(inf, &places);
+
+    rs_read_stats(inf, &max_stats);
+    rs_read_rooms(inf, rooms, MAXROOMS);
+    for (rp = rooms; rp < &rooms[MAXROOMS]; rp++)
+        mark_room(rp);
+    rs_read_room_reference(inf, &oldrp);
+    rs_read_rooms(inf, passages, MAXPASS);
+
+    rs_read_monsters(inf,monsters,26);                  
+    rs_read_obj_info(inf, things,   NUMTHINGS);         
+    rs_read_obj_info(inf, arm_info,   MAXARMORS);         
+    rs_read_obj_info(inf, pot_info,  MAXPOTIONS);       
+    rs_read_obj_info(inf, ring_info,  MAXRINGS);         
+    rs_read_obj_info(inf, scr_info,  MAXSCROLLS);       
+    rs_read_obj_info(inf, weap_info, MAXWEAPONS+1);       
+    rs_read_obj_info(inf, ws_info, MAXSTICKS);       
+
+    rs_read_daemons(inf);                               /* 5.4-daemon.c     */
+    rs_read_int(inf,&dummyint);  /* total */            /* 5.4-list.c    */
+    rs_read_int(inf,&between);                          /* 5.4-daemons.c    */
+    rs_read_coord(inf, &nh);                            /* 5.4-move.c       */
+    rs_read_int(inf,&group);                            /* 5.4-weapons.c    */
+    
+    rs_read_window(inf,stdscr);
+    rs_read_rng(inf, &game->g_rng);
+
+    return(READSTAT);
+}
+
+int
+rs_restore_file(FILE *inf)
+{
+    struct rs_section sect[RSEC_MAX];
+    unsigned int magic;
+    size_t start;
+
+    if (read_error || format_error)
+        return(READSTAT);
+
+    rs_forget_lists();
+    start = savepos();
+    if (rs_read_uint(inf, &magic) != 0 || magic != RS_MAGIC)
+    {
+        read_error = 0;
+        saveseek(start);
+        flowchase = FALSE;
+        rs_restore_fields(inf);
+        rs_forget_lists();
+        hash_reset();
+        return(READSTAT);
+    }
+
+    rs_read_sections(inf, sect);
+
+    /*
+     * Things on the level point at objects and rooms, and the map
+     * points at monsters, so they go in that order
+     */
+    rs_seek_section(sect, RSEC_GLOBALS);
+    rs_read_globals(inf);
+    turns = 0;
+    if (rs_more_section(sect, RSEC_GLOBALS))
+        rs_read_int(inf, &turns);
+    flowchase = FALSE;
+    if (rs_more_section(sect, RSEC_GLOBALS))
+        rs_read_boolean(inf, &flowchase);
+    rs_check_section(sect, RSEC_GLOBALS);
+
+    rs_seek_section(sect, RSEC_OBJECTS);
+    rs_read_object_list(inf, &lvl_obj);
+    rs_check_section(sect, RSEC_OBJECTS);
+
+    rs_seek_section(sect, RSEC_MONSTERS);
+    rs_read_thing_list(inf, &mlist);
+    rs_check_section(sect, RSEC_MONSTERS);
+
+    rs_seek_section(sect, RSEC_PLAYER);
+    rs_read_player(inf);
+    rs_check_section(sect, RSEC_PLAYER);
+
+    rs_seek_section(sect, RSEC_PACK);
+    rs_read_pack(inf);
+    rs_check_section(sect, RSEC_PACK);
+
+    rs_fix_thing(&player);
+    rs_fix_thing_list(mlist);
+
+    rs_seek_section(sect, RSEC_LEVEL);
+    rs_read_level(inf);
+    rs_check_section(sect, RSEC_LEVEL);
+
+    rs_seek_section(sect, RSEC_DAEMONS);
+    rs_read_daemon_array(inf);
+    rs_check_section(sect, RSEC_DAEMONS);
+
+    if (sect[RSEC_SCREEN].s_found || !sect[RSEC_WINDOW].s_found)
+    {
+        rs_seek_section(sect, RSEC_SCREEN);
+        rs_read_shadow(inf);
+        rs_check_section(sect, RSEC_SCREEN);
+    }
+    else
+    {
+        rs_seek_section(sect, RSEC_WINDOW);
+        rs_read_screen(inf, stdscr);
+        rs_check_section(sect, RSEC_WINDOW);
+    }
+
+    rs_forget_lists();
+    hash_reset();
 
     return(READSTAT);
 }
@@ -29,6 +29,8 @@ fix_stick(THING *cur)
     else
 	strncpy(cur->o_damage,"1x1",sizeof(cur->o_damage));
     strncpy(cur->o_hurldmg,"1x1",sizeof(cur->o_hurldmg));
+    set_dice(&cur->o_dice, cur->o_damage);
+    set_dice(&cur->o_hurldice, cur->o_hurldmg);
 
     switch (cur->o_which)
     {
@@ -51,7 +53,7 @@ do_zap()
     int y, x;
     char *name;
     char monster, oldch;
-    static THING bolt;
+    static TLOCAL THING bolt;
 
     if ((obj = get_item("zap with", STICK)) == NULL)
 	return;
@@ -176,6 +178,7 @@ do_zap()
 	    ws_info[WS_MISSILE].oi_know = TRUE;
 	    bolt.o_type = '*';
 	    strncpy(bolt.o_hurldmg,"1x4",sizeof(bolt.o_hurldmg));
+	    set_dice(&bolt.o_hurldice, bolt.o_hurldmg);
 	    bolt.o_hplus = 100;
 	    bolt.o_dplus = 1;
 	    bolt.o_flags = ISMISL;
@@ -253,7 +256,7 @@ drain()
     THING **dp;
     int cnt;
     bool inpass;
-    static THING *drainee[40];
+    static TLOCAL THING *drainee[40];
 
     /*
      * First cnt how many things we need to spread the hit points among
@@ -303,13 +306,15 @@ fire_bolt(coord *start, coord *dir, char *name)
     THING *tp;
     char dirch = 0, ch;
     bool hit_hero, used, changed;
-    static coord pos;
-    static coord spotpos[BOLT_LENGTH];
+    static TLOCAL coord pos;
+    static TLOCAL coord spotpos[BOLT_LENGTH];
     THING bolt;
 
     bolt.o_type = WEAPON;
     bolt.o_which = FLAME;
     strncpy(bolt.o_hurldmg,"6x6",sizeof(bolt.o_hurldmg));
+    set_dice(&bolt.o_hurldice, bolt.o_hurldmg);
+    bolt.o_dice.dc_cnt = 0;		/* it is never wielded */
     bolt.o_hplus = 100;
     bolt.o_dplus = 0;
     weap_info[FLAME].oi_name = name;
@@ -405,7 +410,7 @@ def:
 			msg("the %s whizzes by you", name);
 		}
 		mvaddch(pos.y, pos.x, dirch);
-		refresh();
+		anim_frame();
 	}
     }
     for (c2 = spotpos; c2 < c1; c2++)
@@ -419,7 +424,7 @@ def:
 char *
 charge_str(THING *obj)
 {
-    static char buf[20];
+    static TLOCAL char buf[20];
 
     if (!(obj->o_flags & ISKNOW))
 	buf[0] = '\0';
@@ -159,10 +159,10 @@ drop()
     /*
      * Link it into the level object list
      */
+    obj->o_pos = hero;
     attach(lvl_obj, obj);
-    chat(hero.y, hero.x) = (char) obj->o_type;
+    set_chat(hero.y, hero.x, (char) obj->o_type);
     flat(hero.y, hero.x) |= F_DROPPED;
-    obj->o_pos = hero;
     if (obj->o_type == AMULET)
 	amulet = FALSE;
     msg("dropped %s", inv_name(obj, TRUE));
@@ -224,6 +224,8 @@ new_thing()
     cur->o_dplus = 0;
     strncpy(cur->o_damage, "0x0", sizeof(cur->o_damage));
     strncpy(cur->o_hurldmg, "0x0", sizeof(cur->o_hurldmg));
+    set_dice(&cur->o_dice, cur->o_damage);
+    set_dice(&cur->o_hurldice, cur->o_hurldmg);
     cur->o_arm = 11;
     cur->o_count = 1;
     cur->o_group = 0;
@@ -332,11 +334,11 @@ pick_one(struct obj_info *info, int nitems)
  * discovered:
  *	list what the player has discovered in this game of a certain type
  */
-static int line_cnt = 0;
-
-static bool newpage = FALSE;
-
-static char *lastfmt, *lastarg;
+#define line_cnt	(game->g_line_cnt)
+#define newpage		(game->g_newpage)
+#define lastfmt		(game->g_lastfmt)
+#define lastarg		(game->g_lastarg)
+#define maxlen		(game->g_maxlen)
 
 
 void
@@ -404,7 +406,7 @@ print_disc(char type)
 {
     struct obj_info *info = NULL;
     int i, maxnum = 0, num_found;
-    static THING obj;
+    static TLOCAL THING obj;
     static int order[MAX4(MAXSCROLLS, MAXPOTIONS, MAXRINGS, MAXSTICKS)];
 
     switch (type)
@@ -475,7 +477,6 @@ add_line(char *fmt, char *arg)
     WINDOW *tw, *sw;
     int x, y;
     char *prompt = "--Press space to continue--";
-    static int maxlen = -1;
 
     if (line_cnt == 0)
     {
@@ -14,4 +14,5 @@
 char *release = "5.4.4";
 char encstr[] = "\300k||`\251Y.'\305\321\201+\277~r\"]\240_\223=1\341)\222\212\241t;\t$\270\314/<#\201\254";
 char statlist[] = "\355kl{+\204\255\313idJ\361\214=4:\311\271\341wK<\312\321\213,,7\271/Rk%\b\312\f\246";
-char version[] = "rogue (rogueforge) 09/05/07";
+char version[] = "rogue (rogueforge) 10/16/26";
+char oversion[] = "rogue (rogueforge) 09/05/07";	/* Saved a field at a time */
@@ -0,0 +1,119 @@
+/*
+ * Publish each frame the game draws in the watch file, so others can
+ * watch the game without getting in its way.  See watch.h for the
+ * layout.
+ *
+ * Rogue: Exploring the Dungeons of Doom
+ * Copyright (C) 1980-1983, 1985, 1999 Michael Toy, Ken Arnold and Glenn Wichman
+ * All rights reserved.
+ *
+ * See the file LICENSE.TXT for full copyright and licensing information.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include <curses.h>
+#include "rogue.h"
+#include "watch.h"
+
+/*
+ * The writes to a frame have to be seen before its sequence number
+ * says it is whole
+ */
+#if defined(__GNUC__)
+#define BARRIER()	__sync_synchronize()
+#else
+#define BARRIER()
+#endif
+
+#define watch_map	(game->g_watch_map)
+#define watch_size	(game->g_watch_size)
+#define watch_at	(game->g_watch_at)
+#define watch_name	(game->g_watch_name)
+#define watch_n		(game->g_watch_n)
+
+/*
+ * watch_open:
+ *	Map the watch file and set up its header
+ */
+static void
+watch_open()
+{
+    struct watch_head *wh;
+    unsigned char *sp;
+    size_t size;
+    int lines, cols;
+
+    strcpy(watch_at, watch_name);
+    sp = sh_at(&lines, &cols);
+    if (sp == NULL || lines <= 0 || cols <= 0)
+	return;
+    size = offsetof(struct watch_frame, wf_screen) + lines * cols;
+    size = (size + 7) & ~7;
+    watch_size = sizeof *wh + WATCH_SLOTS * size;
+    if ((watch_map = md_mapfile(watch_name, watch_size)) == NULL)
+	return;
+    wh = (struct watch_head *) watch_map;
+    memset(wh, 0, watch_size);
+    wh->wh_version = WATCH_VERSION;
+    wh->wh_slots = WATCH_SLOTS;
+    wh->wh_size = (unsigned int) size;
+    wh->wh_lines = lines;
+    wh->wh_cols = cols;
+    wh->wh_pid = md_getpid();
+    BARRIER();
+    wh->wh_magic = WATCH_MAGIC;
+    watch_n = 0;
+}
+
+/*
+ * watch_close:
+ *	Stop publishing frames
+ */
+void
+watch_close()
+{
+    if (watch_map != NULL)
+	md_unmapfile(watch_map, watch_size);
+    watch_map = NULL;
+    watch_at[0] = '\0';
+}
+
+/*
+ * watch_frame:
+ *	Put the screen as it is now into the next slot
+ */
+void
+watch_frame()
+{
+    struct watch_head *wh;
+    struct watch_frame *wf;
+    unsigned char *sp;
+    int lines, cols;
+
+    if (replaying)
+	return;
+    if (strcmp(watch_name, watch_at) != 0)
+    {
+	watch_close();
+	if (watch_name[0] != '\0')
+	    watch_open();
+    }
+    if (watch_map == NULL)
+	return;
+    wh = (struct watch_head *) watch_map;
+    sp = sh_at(&lines, &cols);
+    if (sp == NULL || lines != (int) wh->wh_lines || cols != (int) wh->wh_cols)
+	return;
+    watch_n++;
+    wf = WATCH_FRAME(wh, watch_n);
+    wf->wf_seq = 2 * watch_n - 1;
+    BARRIER();
+    wf->wf_turn = turns;
+    getyx(stdscr, wf->wf_y, wf->wf_x);
+    memcpy(wf->wf_screen, sp, lines * cols);
+    BARRIER();
+    wf->wf_seq = 2 * watch_n;
+    BARRIER();
+    wh->wh_last = watch_n;
+}
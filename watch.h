@@ -0,0 +1,54 @@
+/*
+ * Layout of the watch file, where a game shows each frame it draws
+ * to anyone who wants to watch
+ *
+ * Rogue: Exploring the Dungeons of Doom
+ * Copyright (C) 1980-1983, 1985, 1999 Michael Toy, Ken Arnold and Glenn Wichman
+ * All rights reserved.
+ *
+ * See the file LICENSE.TXT for full copyright and licensing information.
+ */
+
+/*
+ * The file is a watch_head followed by WATCH_SLOTS slots of wh_size
+ * bytes each, and the game maps it shared and writes frames into it
+ * round and round.  Frame n (counting from 1) goes in slot
+ * n % wh_slots.  The game is the only writer and never waits for
+ * anybody; a watcher reads like this:
+ *
+ *	n = wh_last;			(0 means nothing yet)
+ *	seq = wf_seq of slot n;		(must be 2 * n, or try again)
+ *	copy the frame;
+ *	check wf_seq is still seq;	(if not, it was overwritten)
+ *
+ * A watcher that falls behind just skips to the newest frame.
+ */
+
+#define WATCH_MAGIC	0x54574752	/* "RGWT" */
+#define WATCH_VERSION	1
+#define WATCH_SLOTS	8
+
+struct watch_head {
+    unsigned int wh_magic;		/* WATCH_MAGIC */
+    unsigned int wh_version;		/* WATCH_VERSION */
+    unsigned int wh_slots;		/* Number of frame slots */
+    unsigned int wh_size;		/* Bytes in a slot */
+    unsigned int wh_lines;		/* Size of the screen */
+    unsigned int wh_cols;
+    unsigned int wh_pid;		/* Process writing it */
+    volatile unsigned int wh_last;	/* Newest whole frame */
+};
+
+struct watch_frame {
+    volatile unsigned int wf_seq;	/* 2n when frame n is whole, odd
+					 * while it is being written */
+    unsigned int wf_turn;		/* Game turn it was drawn on */
+    int wf_y, wf_x;			/* Where the cursor is */
+    unsigned char wf_screen[4];		/* wh_lines * wh_cols bytes, a
+					 * character to a place with the
+					 * top bit set for standout */
+};
+
+#define WATCH_FRAME(wh, n) \
+	((struct watch_frame *) ((char *) ((wh) + 1) \
+	    + ((n) % (wh)->wh_slots) * (wh)->wh_size))
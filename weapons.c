@@ -17,8 +17,6 @@
 
 #define NO_WEAPON -1
 
-int group = 2;
-
 static struct init_weaps {
     char *iw_dam;	/* Damage when wielded */
     char *iw_hrl;	/* Damage when thrown */
@@ -105,7 +103,7 @@ do_motion(THING *obj, int ydelta, int xdelta)
 	    if (cansee(unc(obj->o_pos)) && !terse)
 	    {
 		mvaddch(obj->o_pos.y, obj->o_pos.x, obj->o_type);
-		refresh();
+		anim_frame();
 	    }
 	    continue;
 	}
@@ -121,18 +119,18 @@ do_motion(THING *obj, int ydelta, int xdelta)
 void
 fall(THING *obj, bool pr)
 {
-    PLACE *pp;
-    static coord fpos;
+    int pp;
+    static TLOCAL coord fpos;
 
     if (fallpos(&obj->o_pos, &fpos))
     {
 	pp = INDEX(fpos.y, fpos.x);
-	pp->p_ch = (char) obj->o_type;
+	set_chat(fpos.y, fpos.x, (char) obj->o_type);
 	obj->o_pos = fpos;
 	if (cansee(fpos.y, fpos.x))
 	{
-	    if (pp->p_monst != NULL)
-		pp->p_monst->t_oldch = (char) obj->o_type;
+	    if (places.p_mon[pp] != 0)
+		mslot[places.p_mon[pp]]->t_oldch = (char) obj->o_type;
 	    else
 		mvaddch(fpos.y, fpos.x, obj->o_type);
 	}
@@ -167,6 +165,8 @@ init_weapon(THING *weap, int which)
     iwp = &init_dam[which];
     strncpy(weap->o_damage, iwp->iw_dam, sizeof(weap->o_damage));
     strncpy(weap->o_hurldmg,iwp->iw_hrl, sizeof(weap->o_hurldmg));
+    set_dice(&weap->o_dice, weap->o_damage);
+    set_dice(&weap->o_hurldice, weap->o_hurldmg);
     weap->o_launch = iwp->iw_launch;
     weap->o_flags = iwp->iw_flags;
     weap->o_hplus = 0;
@@ -195,7 +195,7 @@ init_weapon(THING *weap, int which)
 int
 hit_monster(int y, int x, THING *obj)
 {
-    static coord mp;
+    static TLOCAL coord mp;
 
     mp.y = y;
     mp.x = x;
@@ -209,7 +209,7 @@ hit_monster(int y, int x, THING *obj)
 char *
 num(int n1, int n2, char type)
 {
-    static char numbuf[10];
+    static TLOCAL char numbuf[10];
 
     sprintf(numbuf, n1 < 0 ? "%d" : "+%d", n1);
     if (type == WEAPON)
@@ -199,7 +199,7 @@ create_obj()
 void
 teleport()
 {
-    static coord c;
+    static TLOCAL coord c;
 
     mvaddch(hero.y, hero.x, floor_at());
     find_floor((struct room *) NULL, &c, FALSE, TRUE);
@@ -223,6 +223,7 @@ teleport()
 	player.t_flags &= ~ISHELD;
 	vf_hit = 0;
 	strcpy(monsters['F'-'A'].m_stats.s_dmg, "000x0");
+	set_dice(&monsters['F'-'A'].m_stats.s_dice, "000x0");
     }
     no_move = 0;
     count = 0;
@@ -239,7 +240,7 @@ int
 passwd()
 {
     char *sp, c;
-    static char buf[MAXSTR];
+    static TLOCAL char buf[MAXSTR];
 
     msg("wizard's Password:");
     mpos = 0;